@@ -7,13 +7,21 @@ Measure::Measure(){
 }
 
 Measure::Metrics Measure::GetMetrics() const noexcept {
+  using namespace std::chrono;
+
+  const auto common_measure_delta = previous_call_time_point_ - first_call_time_point_;
+  const auto seconds = duration<double>(common_measure_delta).count();
+
   Metrics metrics{
     call_count_,
-    avg_call_count_per_second_,
-    time_avg_ns_,
-    time_min_ns_,
-    time_max_ns_,
-    median_.GetMedian()
+    seconds > 0 ? static_cast<uint64_t>(static_cast<double>(intervals_.Count()) / seconds) : 0,
+    intervals_.Mean(),
+    intervals_.Min(),
+    intervals_.Max(),
+    intervals_.Percentile(50),
+    intervals_.Percentile(90),
+    intervals_.Percentile(99),
+    intervals_.Percentile(99.9)
   };
 
   return metrics;
@@ -23,46 +31,34 @@ void Measure::IncrementCalls() noexcept {
   using namespace std::chrono;
   const auto current_time_point = high_resolution_clock::now();
 
+  ++call_count_;
+
   if (!first_call_time_point_.time_since_epoch().count()) {
     first_call_time_point_ = current_time_point;
-  }
-
-  if (!previous_call_time_point_.time_since_epoch().count()) {
     previous_call_time_point_ = current_time_point;
-    ++call_count_;
     return;
   }
 
-  const auto one_call_measure_delta = current_time_point - previous_call_time_point_;
-  const auto common_measure_delta = current_time_point - first_call_time_point_;
-
-  ++call_count_;
-  avg_call_count_per_second_ = (call_count_ / duration_cast<milliseconds>(common_measure_delta).count()) * 1'000;
-  time_avg_ns_ = common_measure_delta / call_count_;
-
-  if (one_call_measure_delta < time_min_ns_) {
-    time_min_ns_ = one_call_measure_delta;
-  }
-
-  if (one_call_measure_delta > time_max_ns_) {
-    time_max_ns_ = one_call_measure_delta;
-  }
-
-  median_.Push(one_call_measure_delta);
+  //
+  // constant memory and O(1), so the measurement doesn't distort the result
+  //
+  intervals_.Record(current_time_point - previous_call_time_point_);
+  previous_call_time_point_ = current_time_point;
 }
 
 uint64_t Measure::CallCount() const noexcept {
   return call_count_;
 }
 
+const mdo::Histogram& Measure::Intervals() const noexcept {
+  return intervals_;
+}
+
 void Measure::Reset() {
-  call_count_ = std::numeric_limits<uint64_t>::min();
-  avg_call_count_per_second_ = std::numeric_limits<uint64_t>::min();
-  time_avg_ns_ = std::chrono::nanoseconds{std::numeric_limits<Rep>::min()};
-  time_min_ns_ = std::chrono::nanoseconds{std::numeric_limits<Rep>::max()};
-  time_max_ns_ = std::chrono::nanoseconds{std::numeric_limits<Rep>::min()};
+  call_count_ = 0;
+  intervals_.Reset();
   previous_call_time_point_ = TimePoint{};
   first_call_time_point_ = TimePoint{};
 }
 
-}
\ No newline at end of file
+}
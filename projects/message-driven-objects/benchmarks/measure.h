@@ -1,6 +1,6 @@
 #pragma once
 
-#include "running_median.h"
+#include "histogram.h"
 
 namespace benchmarks {
 
@@ -17,7 +17,10 @@ class Measure {
     std::chrono::nanoseconds time_avg;
     std::chrono::nanoseconds time_min;
     std::chrono::nanoseconds time_max;
-    std::chrono::nanoseconds time_median;
+    std::chrono::nanoseconds time_p50;
+    std::chrono::nanoseconds time_p90;
+    std::chrono::nanoseconds time_p99;
+    std::chrono::nanoseconds time_p999;
   };
 
   Measure();
@@ -27,19 +30,19 @@ class Measure {
   void IncrementCalls() noexcept;
   uint64_t CallCount() const noexcept;
 
+  //
+  // the intervals between the calls, can be merged with the histograms of
+  // the measures running in other threads
+  //
+  const mdo::Histogram& Intervals() const noexcept;
+
   void Reset();
 
  private:
-  using Rep = std::chrono::nanoseconds::rep;
-
   uint64_t call_count_;
-  uint64_t avg_call_count_per_second_;
-  std::chrono::nanoseconds time_avg_ns_;
-  std::chrono::nanoseconds time_min_ns_;
-  std::chrono::nanoseconds time_max_ns_;
-  RunningMedian<std::chrono::nanoseconds> median_;
+  mdo::Histogram intervals_;
   TimePoint first_call_time_point_;
   TimePoint previous_call_time_point_;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,302 @@
+#include "dispatcher.h"
+#include "future.h"
+#include "measure.h"
+#include "message_handlers.h"
+#include "sink.h"
+#include "thread.h"
+#include "trace.h"
+
+using namespace mdo;
+using namespace benchmarks;
+using namespace std::chrono;
+
+namespace {
+
+//
+// the producers are faster than the consumers, the bounded queues make them
+// run at the consumers' pace instead of measuring the memory allocator
+//
+constexpr size_t kQueueCapacity = 64 * 1024;
+
+struct Consumer {
+  explicit Consumer(const std::string& name)
+      : thread{Thread::Create(name.c_str())},
+        sink{MakeUnique<Sink>(thread.get())} {
+    thread->SetQueueLimits({.capacity = kQueueCapacity, .policy = OverflowPolicy::kBlock});
+    thread->Start();
+  }
+
+  ~Consumer() { thread->Stop(); }
+
+  std::unique_ptr<Thread> thread;
+  ObjectPtr<Sink> sink;
+};
+
+//
+// shared by the producer threads of the N->1 benchmark, created and
+// destroyed by the first producer around the timed loop
+//
+std::unique_ptr<Consumer> shared_consumer;
+
+void ManyToOne(benchmark::State& state) {
+  const auto payload = std::string(static_cast<size_t>(state.range(0)), 'x');
+
+  if (state.thread_index() == 0) {
+    shared_consumer = std::make_unique<Consumer>("consumer");
+  }
+
+  for (auto _ : state) {
+    Dispatcher::Dispatch(TestMessage{payload, nullptr, shared_consumer->sink.get()});
+  }
+
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.range(0)) {
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+  }
+
+  if (state.thread_index() == 0) {
+    shared_consumer->sink->WaitFor(state.iterations() * static_cast<uint64_t>(state.threads()));
+    shared_consumer.reset();
+  }
+}
+
+void OneToMany(benchmark::State& state) {
+  const auto consumers_count = static_cast<size_t>(state.range(0));
+  const auto payload = std::string(static_cast<size_t>(state.range(1)), 'x');
+
+  std::vector<std::unique_ptr<Consumer>> consumers;
+
+  for (size_t i = 0; i < consumers_count; ++i) {
+    consumers.push_back(std::make_unique<Consumer>("consumer_" + std::to_string(i)));
+  }
+
+  size_t next = 0;
+
+  for (auto _ : state) {
+    Dispatcher::Dispatch(TestMessage{payload, nullptr, consumers[next]->sink.get()});
+    next = next + 1 == consumers_count ? 0 : next + 1;
+  }
+
+  for (size_t i = 0; i < consumers_count; ++i) {
+    consumers[i]->sink->WaitFor((state.iterations() + consumers_count - 1 - i) / consumers_count);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.range(1)) {
+    state.SetBytesProcessed(state.iterations() * state.range(1));
+  }
+}
+
+//
+// the round trip of a message to the object in another thread and of its
+// reply, the percentiles of the round trip time are reported as counters
+//
+void PingPong(benchmark::State& state) {
+  class Ponger : public Object {
+   public:
+    Ponger(mdo::Thread* thread, MessageQueue& replies)
+        : Object{thread},
+          replies_{replies} {}
+
+   protected:
+    void OnTestMessage(TestMessage&) override {
+      replies_.Post(TestMessage{"", this, nullptr});
+    }
+
+   private:
+    MessageQueue& replies_;
+  };
+
+  const auto strategy = static_cast<WaitStrategy>(state.range(0));
+  const auto wait_timeout = strategy == WaitStrategy::kBusyPoll ? 0ns : MessageQueue::kInfiniteTimeout;
+
+  MessageQueue replies;
+  std::vector<Message> messages;
+
+  replies.SetWaitOptions({.strategy = strategy});
+
+  const auto thread = Thread::Create("ponger");
+  thread->SetWaitOptions({.strategy = strategy});
+
+  const auto ponger = MakeUnique<Ponger>(thread.get(), replies);
+
+  thread->Start();
+
+  Measure measure;
+
+  for (auto _ : state) {
+    Dispatcher::Dispatch(TestMessage{"", nullptr, ponger.get()});
+
+    while (replies.Poll(messages, wait_timeout)) {}
+
+    measure.IncrementCalls();
+  }
+
+  thread->Stop();
+
+  const auto metrics = measure.GetMetrics();
+
+  state.counters["p50_ns"] = static_cast<double>(metrics.time_p50.count());
+  state.counters["p99_ns"] = static_cast<double>(metrics.time_p99.count());
+  state.counters["p99.9_ns"] = static_cast<double>(metrics.time_p999.count());
+  state.counters["max_ns"] = static_cast<double>(metrics.time_max.count());
+}
+
+//
+// request/reply round trip to another thread: Invoke() with the pooled
+// completion slot vs std::promise and a lambda message
+//
+class Adder : public Object {
+ public:
+  explicit Adder(mdo::Thread* thread) : Object{thread} {}
+
+  int Add(int lhs, int rhs) const noexcept { return lhs + rhs; }
+};
+
+void InvokeRoundTrip(benchmark::State& state) {
+  const auto thread = Thread::Create("adder");
+  const auto adder = MakeUnique<Adder>(thread.get());
+
+  thread->Start();
+
+  int sum = 0;
+
+  for (auto _ : state) {
+    sum = Invoke(adder.get(), &Adder::Add, sum, 1).Get().value_or(0);
+  }
+
+  thread->Stop();
+
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+void PromiseRoundTrip(benchmark::State& state) {
+  const auto thread = Thread::Create("adder");
+  const auto adder = MakeUnique<Adder>(thread.get());
+
+  thread->Start();
+
+  int sum = 0;
+
+  for (auto _ : state) {
+    auto promise = std::make_shared<std::promise<int>>();
+    auto future = promise->get_future();
+    const auto receiver = adder.get();
+
+    Dispatcher::Dispatch(InvokeSlotMessage{
+      [promise, receiver, sum] { promise->set_value(receiver->Add(sum, 1)); },
+      nullptr,
+      receiver});
+
+    sum = future.get();
+  }
+
+  thread->Stop();
+
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+//
+// the cost of delivering a message to the handler: the closed variant vs
+// the type erased AnyMessage
+//
+struct Ping {
+  uint64_t value;
+};
+
+class PingReceiver : public Object {
+ public:
+  using Handlers = MessageHandlers<PingReceiver, Ping>;
+
+  uint64_t Sum() const noexcept { return sum_; }
+
+ protected:
+  void OnBenchmarkMessage(BenchmarkMessage&) override { ++sum_; }
+
+  void OnAnyMessage(AnyMessage& message) override { Handlers::Dispatch(this, message); }
+
+ private:
+  friend Handlers;
+
+  void Handle(Ping& ping) { sum_ += ping.value; }
+
+ private:
+  uint64_t sum_ = 0;
+};
+
+template <typename T>
+void MessageDispatch(benchmark::State& state) {
+  PingReceiver receiver;
+  Message message;
+
+  if constexpr (std::is_same_v<T, AnyMessage>) {
+    message = AnyMessage{Ping{1}, nullptr, &receiver};
+  } else {
+    message = T{nullptr, &receiver};
+  }
+
+  for (auto _ : state) {
+    receiver.OnMessage(message);
+  }
+
+  benchmark::DoNotOptimize(receiver.Sum());
+  state.SetItemsProcessed(state.iterations());
+}
+
+//
+// the cost of the tracing hooks per message: the dispatched and the handled
+// records, the flushing thread drains the ring meanwhile
+//
+void TraceMessage(benchmark::State& state) {
+  const auto path = std::filesystem::temp_directory_path() / "mdo_benchmark.trace";
+  PingReceiver receiver;
+  Message message{AnyMessage{Ping{1}, nullptr, &receiver}};
+
+  if (const auto error = Tracer::Start(path, {.max_records = 1024})) {
+    state.SkipWithError(error.message().c_str());
+    return;
+  }
+
+  for (auto _ : state) {
+    details::TraceDispatched(message);
+    details::TraceHandled(message);
+  }
+
+  Tracer::Stop();
+  std::filesystem::remove(path);
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+}// namespace
+
+BENCHMARK(ManyToOne)
+  ->ArgName("bytes")
+  ->Arg(0)
+  ->Arg(1024)
+  ->ThreadRange(1, 8)
+  ->UseRealTime();
+
+BENCHMARK(OneToMany)
+  ->ArgNames({"consumers", "bytes"})
+  ->ArgsProduct({{1, 2, 4, 8}, {0, 1024}})
+  ->UseRealTime();
+
+BENCHMARK(PingPong)
+  ->ArgName("strategy")
+  ->Arg(static_cast<int64_t>(WaitStrategy::kSleep))
+  ->Arg(static_cast<int64_t>(WaitStrategy::kBusyPoll))
+  ->Arg(static_cast<int64_t>(WaitStrategy::kAdaptive))
+  ->UseRealTime();
+
+BENCHMARK(InvokeRoundTrip)->UseRealTime();
+BENCHMARK(PromiseRoundTrip)->UseRealTime();
+
+BENCHMARK_TEMPLATE(MessageDispatch, BenchmarkMessage);
+BENCHMARK_TEMPLATE(MessageDispatch, AnyMessage);
+
+BENCHMARK(TraceMessage);
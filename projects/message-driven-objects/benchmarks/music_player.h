@@ -1,37 +0,0 @@
-#pragma once
-
-#include "object.h"
-#include "signal_impl.h"
-
-namespace benchmarks {
-
-using namespace mdo;
-
-class MusicPlayer : public Object {
-public:
-  struct Song {
-    std::string name;
-    std::string singer;
-  };
-
-  explicit MusicPlayer(uint64_t iterations);
-
-  uint64_t GetVolume() const noexcept;
-  void SetVolume(uint64_t value) noexcept;
-
-  const Song& GetSong() const noexcept;
-  void SetSong(const Song& song);
-
-  Signal<uint64_t> VolumeChanged;
-  Signal<const Song&> SongChanged;
-
-private:
-  void OnThreadStarted();
-
-private:
-  uint64_t volume_;
-  Song song_;
-  uint64_t iterations_;
-};
-
-}
\ No newline at end of file
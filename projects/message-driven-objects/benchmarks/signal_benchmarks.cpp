@@ -0,0 +1,196 @@
+#include "shared_buffer.h"
+#include "signal_impl.h"
+#include "sink.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace benchmarks;
+
+namespace {
+
+class Sender : public Object {
+ public:
+  Sender() : ValueChanged{this} {}
+
+  Signal<uint64_t> ValueChanged;
+};
+
+//
+// the baseline for the same thread emit
+//
+void VirtualCall(benchmark::State& state) {
+  class Base {
+   public:
+    virtual ~Base() = default;
+    virtual void OnValue(uint64_t value) = 0;
+  };
+
+  class Receiver : public Base {
+   public:
+    void OnValue(uint64_t value) override { sum_ += value; }
+
+    uint64_t Sum() const noexcept { return sum_; }
+
+   private:
+    uint64_t sum_ = 0;
+  };
+
+  Receiver receiver;
+  Base* base = &receiver;
+
+  for (auto _ : state) {
+    //
+    // otherwise the call is devirtualized and inlined
+    //
+    benchmark::DoNotOptimize(base);
+    base->OnValue(1);
+  }
+
+  benchmark::DoNotOptimize(receiver.Sum());
+  state.SetItemsProcessed(state.iterations());
+}
+
+void SignalEmitSameThread(benchmark::State& state) {
+  const auto connections = static_cast<size_t>(state.range(0));
+
+  Sender sender;
+  std::vector<ObjectPtr<Sink>> sinks;
+
+  for (size_t i = 0; i < connections; ++i) {
+    sinks.push_back(MakeUnique<Sink>());
+    sender.ValueChanged.Connect(sinks.back().get(), &Sink::OnValue);
+  }
+
+  for (auto _ : state) {
+    sender.ValueChanged(1);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void SignalEmitCrossThread(benchmark::State& state) {
+  const auto mode = static_cast<DeliveryMode>(state.range(0));
+
+  const auto thread = Thread::Create("receiver");
+  thread->SetQueueLimits({.capacity = 64 * 1024, .policy = OverflowPolicy::kBlock});
+
+  Sender sender;
+  const auto sink = MakeUnique<Sink>(thread.get());
+
+  sender.ValueChanged.Connect(sink.get(), &Sink::OnValue, mode);
+
+  thread->Start();
+
+  for (auto _ : state) {
+    sender.ValueChanged(1);
+  }
+
+  //
+  // the batched connection delivers all pending emits in one message, but
+  // calls the slot for each of them
+  //
+  sink->WaitFor(state.iterations());
+
+  thread->Stop();
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(mode == DeliveryMode::kQueued ? "queued" : "batched");
+}
+
+//
+// fan-out of a 64 KB snapshot to 10 receivers in another thread: the copied
+// bytes vs the shared buffer
+//
+void SignalFanOut(benchmark::State& state) {
+  constexpr size_t kSnapshotSize = 64 * 1024;
+  constexpr size_t kReceivers = 10;
+
+  class Publisher : public Object {
+   public:
+    Publisher()
+        : BytesReady{this},
+          BufferReady{this} {}
+
+    Signal<const std::vector<std::byte>&> BytesReady;
+    Signal<const SharedBuffer&> BufferReady;
+  };
+
+  class Receiver : public Object {
+   public:
+    explicit Receiver(mdo::Thread* thread) : Object{thread}, received_{} {}
+
+    void OnBytes(const std::vector<std::byte>& bytes) { Receive(bytes.size()); }
+
+    void OnBuffer(const SharedBuffer& buffer) { Receive(buffer.Size()); }
+
+    uint64_t Received() const noexcept { return received_.load(std::memory_order_acquire); }
+
+   private:
+    void Receive(size_t size) {
+      benchmark::DoNotOptimize(size);
+      received_.store(received_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+   private:
+    std::atomic_uint64_t received_;
+  };
+
+  const auto shared = state.range(0) != 0;
+
+  const auto thread = Thread::Create("receivers");
+  thread->SetQueueLimits({.capacity = 1024, .policy = OverflowPolicy::kBlock});
+
+  Publisher publisher;
+  std::vector<ObjectPtr<Receiver>> receivers;
+
+  for (size_t i = 0; i < kReceivers; ++i) {
+    const auto& receiver = receivers.emplace_back(MakeUnique<Receiver>(thread.get()));
+
+    publisher.BytesReady.Connect(receiver.get(), &Receiver::OnBytes);
+    publisher.BufferReady.Connect(receiver.get(), &Receiver::OnBuffer);
+  }
+
+  thread->Start();
+
+  const std::vector<std::byte> snapshot(kSnapshotSize, std::byte{1});
+
+  for (auto _ : state) {
+    if (shared) {
+      publisher.BufferReady(SharedBuffer{snapshot});
+    } else {
+      publisher.BytesReady(snapshot);
+    }
+  }
+
+  for (const auto& receiver : receivers) {
+    while (receiver->Received() < static_cast<uint64_t>(state.iterations())) {
+      Thread::YieldThread();
+    }
+  }
+
+  thread->Stop();
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kSnapshotSize));
+  state.SetLabel(shared ? "shared" : "copied");
+}
+
+}// namespace
+
+BENCHMARK(VirtualCall);
+
+BENCHMARK(SignalEmitSameThread)
+  ->ArgName("connections")
+  ->Arg(1)
+  ->Arg(8);
+
+BENCHMARK(SignalEmitCrossThread)
+  ->ArgName("mode")
+  ->Arg(static_cast<int64_t>(DeliveryMode::kQueued))
+  ->Arg(static_cast<int64_t>(DeliveryMode::kBatched))
+  ->UseRealTime();
+
+BENCHMARK(SignalFanOut)
+  ->ArgName("shared")
+  ->Arg(0)
+  ->Arg(1)
+  ->UseRealTime();
@@ -0,0 +1,32 @@
+#include "sink.h"
+
+#include "atomic_helpers.h"
+#include "thread.h"
+
+namespace benchmarks {
+
+Sink::Sink() : received_{} {}
+
+Sink::Sink(mdo::Thread* thread)
+    : Object{thread},
+      received_{} {}
+
+void Sink::OnValue(uint64_t) {
+  StoreRelease(received_, LoadRelaxed(received_) + 1);
+}
+
+uint64_t Sink::Received() const noexcept {
+  return LoadAcquire(received_);
+}
+
+void Sink::WaitFor(uint64_t count) const {
+  while (Received() < count) {
+    mdo::Thread::YieldThread();
+  }
+}
+
+void Sink::OnTestMessage(TestMessage&) {
+  StoreRelease(received_, LoadRelaxed(received_) + 1);
+}
+
+}
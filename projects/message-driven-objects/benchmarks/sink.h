@@ -0,0 +1,35 @@
+#pragma once
+
+#include "object.h"
+#include "test_message.h"
+
+namespace benchmarks {
+
+using namespace mdo;
+
+//
+// Counts the messages and the slot calls it receives. The counter is written
+// only by the thread the sink lives in, the benchmark thread waits for it.
+//
+class Sink : public Object {
+ public:
+  Sink();
+  explicit Sink(mdo::Thread* thread);
+
+  void OnValue(uint64_t value);
+
+  uint64_t Received() const noexcept;
+
+  //
+  // blocks until the sink has received 'count' messages in total
+  //
+  void WaitFor(uint64_t count) const;
+
+ protected:
+  void OnTestMessage(TestMessage&) override;
+
+ private:
+  std::atomic_uint64_t received_;
+};
+
+}
@@ -1,19 +1,39 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <coroutine>
 #include <csignal>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <set>
+#include <span>
 #include <sstream>
+#include <stop_token>
+#include <string_view>
 #include <thread>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
 #include <utility>
 #include <functional>
 #include <filesystem>
@@ -37,8 +57,26 @@
 
 #pragma warning(pop)
 
+//
+// tl::expected
+//
+#include <tl/expected.hpp>
+
 #if !defined(_WIN32)
+#if defined(__APPLE__)
 #include <sys/event.h>
+#else
+#include <linux/futex.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#endif
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <unistd.h>
 #else
@@ -60,6 +98,12 @@ std::string ToString(const T& data) {
 #include <SQLiteCpp/Statement.h>
 #include <SQLiteCpp/Transaction.h>
 
+//
+// Google Benchmark
+//
+
+#include <benchmark/benchmark.h>
+
 #include "logger.h"
 
 using namespace std::literals;
\ No newline at end of file
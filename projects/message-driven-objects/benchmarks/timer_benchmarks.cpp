@@ -0,0 +1,158 @@
+#include "histogram.h"
+#include "thread.h"
+#include "timer_message.h"
+#include "timer_service.h"
+
+using namespace mdo;
+using namespace std::chrono;
+
+namespace {
+
+//
+// adds and cancels a timer while the other 'pending' timers are waiting, the
+// intervals are spread from 1 second to ~17 minutes, so the timers get to the
+// different levels of the timer wheel
+//
+void TimerServiceAddCancel(benchmark::State& state) {
+  const auto pending_count = static_cast<size_t>(state.range(0));
+
+  Object receiver;
+  std::vector<int> pending;
+
+  for (size_t i = 0; i < pending_count; ++i) {
+    pending.push_back(TimerService::Instance()->AddTimer(&receiver, 1s + milliseconds{i % 1'000'000}));
+  }
+
+  uint64_t i = 0;
+
+  for (auto _ : state) {
+    const auto id = TimerService::Instance()->AddTimer(&receiver, 1s + milliseconds{i++ % 1'000'000});
+    TimerService::Instance()->RemoveTimer(id);
+  }
+
+  for (const auto id : pending) {
+    TimerService::Instance()->RemoveTimer(id);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void LocalTimersAddCancel(benchmark::State& state) {
+  const auto pending_count = static_cast<size_t>(state.range(0));
+
+  Object receiver;
+  auto& timers = GetThreadData(Thread::Current())->Timers();
+  std::vector<int> pending;
+
+  for (size_t i = 0; i < pending_count; ++i) {
+    pending.push_back(timers.Add(&receiver, 1s + milliseconds{i % 1'000'000}));
+  }
+
+  uint64_t i = 0;
+
+  for (auto _ : state) {
+    timers.Remove(timers.Add(&receiver, 1s + milliseconds{i++ % 1'000'000}));
+  }
+
+  for (const auto id : pending) {
+    timers.Remove(id);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+//
+// re-arms a single shot timer on each tick, so the lateness of each tick
+// doesn't depend on the previous ones; each iteration waits for one tick
+//
+void TimerLateness(benchmark::State& state) {
+  static constexpr auto kInterval = 100us;
+
+  class Receiver : public Object {
+   public:
+    Receiver(mdo::Thread* thread, bool local_timer)
+        : Object{thread},
+          local_timer_{local_timer},
+          ticks_{} {
+      Thread()->Started.Connect(this, &Receiver::Arm);
+    }
+
+    const Histogram& Lateness() const noexcept { return lateness_; }
+
+    uint64_t Ticks() const noexcept { return ticks_; }
+
+   protected:
+    void OnTimerMessage(TimerMessage&) override {
+      lateness_.Record(steady_clock::now() - deadline_);
+      ++ticks_;
+      Arm();
+    }
+
+   private:
+    void Arm() {
+      deadline_ = steady_clock::now() + kInterval;
+
+      if (local_timer_) {
+        GetThreadData(Thread())->Timers().Add(this, kInterval, true);
+      } else {
+        TimerService::Instance()->AddTimer(this, kInterval, true);
+      }
+    }
+
+   private:
+    bool local_timer_;
+    steady_clock::time_point deadline_;
+    Histogram lateness_;
+    std::atomic_uint64_t ticks_;
+  };
+
+  const auto strategy = static_cast<WaitStrategy>(state.range(0));
+  const auto local_timer = state.range(1) != 0;
+
+  const auto thread = Thread::Create("timers");
+  thread->SetWaitOptions({.strategy = strategy});
+
+  Receiver receiver{thread.get(), local_timer};
+
+  thread->Start();
+
+  for (auto _ : state) {
+    const auto ticks = receiver.Ticks();
+
+    while (receiver.Ticks() == ticks) {
+      Thread::YieldThread();
+    }
+  }
+
+  //
+  // the histogram is read after the thread which writes it has stopped
+  //
+  thread->Stop();
+
+  const auto& lateness = receiver.Lateness();
+
+  state.counters["p50_us"] = duration<double, std::micro>(lateness.Percentile(50)).count();
+  state.counters["p99_us"] = duration<double, std::micro>(lateness.Percentile(99)).count();
+  state.counters["p99.9_us"] = duration<double, std::micro>(lateness.Percentile(99.9)).count();
+  state.counters["max_us"] = duration<double, std::micro>(lateness.Max()).count();
+}
+
+}// namespace
+
+BENCHMARK(TimerServiceAddCancel)
+  ->ArgName("pending")
+  ->Arg(0)
+  ->Arg(100'000);
+
+BENCHMARK(LocalTimersAddCancel)
+  ->ArgName("pending")
+  ->Arg(0)
+  ->Arg(100'000);
+
+BENCHMARK(TimerLateness)
+  ->ArgNames({"strategy", "local"})
+  ->Args({static_cast<int64_t>(WaitStrategy::kSleep), 0})
+  ->Args({static_cast<int64_t>(WaitStrategy::kSleep), 1})
+  ->Args({static_cast<int64_t>(WaitStrategy::kHybrid), 1})
+  ->Iterations(2'000)
+  ->UseRealTime();
@@ -9,6 +9,8 @@ void AdoptedThread::Start() {
   LOG_TRACE("starting '{}' thread", CurrentThreadId());
 
   Run();
+
+  SetState(ThreadState::kStopped);
 }
 
 }// namespace mdo
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "any_message.h"
+
+namespace mdo {
+
+AnyMessage::AnyMessage(AnyMessage&& other) noexcept
+    : MessageBase{other},
+      type_{other.type_} {
+  if (type_) {
+    type_->move(&other.storage_, &storage_);
+    other.type_ = nullptr;
+  }
+}
+
+AnyMessage& AnyMessage::operator=(AnyMessage&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  if (type_) {
+    type_->destroy(&storage_);
+  }
+
+  MessageBase::operator=(other);
+  type_ = other.type_;
+
+  if (type_) {
+    type_->move(&other.storage_, &storage_);
+    other.type_ = nullptr;
+  }
+
+  return *this;
+}
+
+AnyMessage::~AnyMessage() {
+  if (type_) {
+    type_->destroy(&storage_);
+  }
+}
+
+MessageTypeId AnyMessage::TypeId() const noexcept { return type_; }
+
+const char* AnyMessage::TypeName() const noexcept {
+  return type_ ? type_->name : "";
+}
+
+}// namespace mdo
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "message_base.h"
+
+namespace mdo {
+
+//!
+//! Describes a type of the payload stored in AnyMessage.
+//! There is exactly one instance of this structure for each payload type, so
+//! its address is used as the type identifier.
+//!
+struct MessageTypeInfo {
+  const char* name;
+  size_t size;
+  void (*move)(void* from, void* to) noexcept;
+  void (*destroy)(void* storage) noexcept;
+};
+
+using MessageTypeId = const MessageTypeInfo*;
+
+//!
+//! Message carrying a payload of an application defined type.
+//!
+//! Applications don't need to extend the Message variant to define own
+//! messages: any move constructible type can be a payload. Payloads which fit
+//! into kInlineSize bytes and are nothrow movable are stored inline, larger
+//! payloads are allocated on the heap, so AnyMessage doesn't make the Message
+//! variant larger.
+//!
+//! The message is received by Object::OnAnyMessage. Use MessageHandlers to
+//! dispatch it to the handler of the payload type.
+//!
+class AnyMessage : public MessageBase {
+ public:
+  static constexpr size_t kInlineSize = 3 * sizeof(void*);
+
+  template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, AnyMessage>>>
+  AnyMessage(T&& payload, Object* sender, Object* receiver)
+      : MessageBase{sender, receiver},
+        type_{TypeIdOf<std::decay_t<T>>()} {
+    using Payload = std::decay_t<T>;
+
+    if constexpr (IsStoredInline<Payload>()) {
+      new (&storage_) Payload(std::forward<T>(payload));
+    } else {
+      new (&storage_) Payload*(new Payload(std::forward<T>(payload)));
+    }
+  }
+
+  AnyMessage(AnyMessage&& other) noexcept;
+  AnyMessage& operator=(AnyMessage&& other) noexcept;
+
+  AnyMessage(const AnyMessage& other) = delete;
+  AnyMessage& operator=(const AnyMessage& other) = delete;
+
+  ~AnyMessage();
+
+  template <typename T>
+  static constexpr MessageTypeId TypeIdOf() noexcept {
+    return &kTypeInfo<T>;
+  }
+
+  [[nodiscard]] MessageTypeId TypeId() const noexcept;
+
+  [[nodiscard]] const char* TypeName() const noexcept;
+
+  template <typename T>
+  [[nodiscard]] bool Is() const noexcept {
+    return type_ == TypeIdOf<T>();
+  }
+
+  //!
+  //! Returns the payload. The payload must be of type T (see Is<T>()).
+  //!
+  template <typename T>
+  [[nodiscard]] T& Payload() noexcept {
+    assert(Is<T>());
+
+    if constexpr (IsStoredInline<T>()) {
+      return *std::launder(reinterpret_cast<T*>(&storage_));
+    } else {
+      return **std::launder(reinterpret_cast<T**>(&storage_));
+    }
+  }
+
+  template <typename T>
+  [[nodiscard]] const T& Payload() const noexcept {
+    return const_cast<AnyMessage*>(this)->Payload<T>();
+  }
+
+ private:
+  template <typename T>
+  static constexpr bool IsStoredInline() noexcept {
+    return sizeof(T) <= kInlineSize &&
+           alignof(T) <= alignof(void*) &&
+           std::is_nothrow_move_constructible_v<T>;
+  }
+
+  template <typename T>
+  static void Move(void* from, void* to) noexcept {
+    if constexpr (IsStoredInline<T>()) {
+      new (to) T(std::move(*std::launder(reinterpret_cast<T*>(from))));
+      std::launder(reinterpret_cast<T*>(from))->~T();
+    } else {
+      new (to) T*(*std::launder(reinterpret_cast<T**>(from)));
+    }
+  }
+
+  template <typename T>
+  static void Destroy(void* storage) noexcept {
+    if constexpr (IsStoredInline<T>()) {
+      std::launder(reinterpret_cast<T*>(storage))->~T();
+    } else {
+      delete *std::launder(reinterpret_cast<T**>(storage));
+    }
+  }
+
+  template <typename T>
+  static inline const MessageTypeInfo kTypeInfo{typeid(T).name(), sizeof(T), &Move<T>, &Destroy<T>};
+
+ private:
+  MessageTypeId type_;
+  alignas(void*) std::byte storage_[kInlineSize];
+};
+
+}// namespace mdo
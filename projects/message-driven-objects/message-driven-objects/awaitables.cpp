@@ -0,0 +1,112 @@
+#include "awaitables.h"
+
+#include "thread.h"
+#include "timer_message.h"
+#include "timer_service.h"
+
+namespace {
+
+//
+// Owns the suspended coroutine until it's resumed, so the message which is
+// destroyed without resuming the coroutine destroys its frame
+//
+class SuspendedCoroutine final {
+ public:
+  explicit SuspendedCoroutine(std::coroutine_handle<> handle) noexcept : handle_{handle} {}
+
+  SuspendedCoroutine(SuspendedCoroutine&& other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+
+  SuspendedCoroutine(const SuspendedCoroutine&) = delete;
+  SuspendedCoroutine& operator=(const SuspendedCoroutine&) = delete;
+
+  ~SuspendedCoroutine() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  void Resume() { std::exchange(handle_, {}).resume(); }
+
+ private:
+  std::coroutine_handle<> handle_;
+};
+
+}// namespace
+
+namespace mdo {
+
+//
+// Receives the timer tick in the thread (or the strand) of the object that
+// awaits and resumes the coroutine through that object, so the coroutine
+// continues with the same Object::Current() as before the suspension.
+//
+class SleepAwaitable::Waker final : public Object {
+ public:
+  Waker(Object* target, std::coroutine_handle<> handle)
+      : Object{target->Thread()},
+        target_{target->Handle()},
+        handle_{handle} {}
+
+  Waker(ThreadPool* pool, Object* target, std::coroutine_handle<> handle)
+      : Object{pool},
+        target_{target->Handle()},
+        handle_{handle} {}
+
+ protected:
+  void OnTimerMessage(TimerMessage&) override {
+    //
+    // if the target is dead, the coroutine frame is destroyed along with the
+    // awaitable owning the waker, so the waker isn't touched after the call
+    //
+    ResumeOn(target_, handle_);
+  }
+
+ private:
+  ObjectHandle target_;
+  std::coroutine_handle<> handle_;
+};
+
+std::error_code ResumeOn(const ObjectHandle& target, std::coroutine_handle<> handle) {
+  const auto error = Dispatcher::Dispatch(InvokeSlotMessage{
+    [coroutine = SuspendedCoroutine{handle}]() mutable { coroutine.Resume(); },
+    ObjectHandle{},
+    target});
+
+  if (error) {
+    LOG_WARNING("failed to resume the coroutine, its frame is destroyed: {}", error.message());
+  }
+
+  return error;
+}
+
+Object* ResumptionTarget() noexcept {
+  if (const auto object = Object::Current()) {
+    return object;
+  }
+
+  return Thread::Current();
+}
+
+SleepAwaitable::SleepAwaitable(const std::chrono::nanoseconds& duration) : duration_{duration} {}
+
+SleepAwaitable::~SleepAwaitable() = default;
+
+bool SleepAwaitable::await_ready() const noexcept { return duration_ <= 0ns; }
+
+void SleepAwaitable::await_suspend(std::coroutine_handle<> handle) {
+  const auto target = ResumptionTarget();
+
+  if (const auto pool = target->Pool()) {
+    waker_ = std::make_unique<Waker>(pool, target, handle);
+  } else {
+    waker_ = std::make_unique<Waker>(target, handle);
+  }
+
+  TimerService::Instance()->AddTimer(waker_.get(), duration_, true);
+}
+
+SleepAwaitable Sleep(const std::chrono::nanoseconds& duration) {
+  return SleepAwaitable{duration};
+}
+
+}// namespace mdo
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "dispatcher.h"
+#include "invoke_slot_message.h"
+#include "object.h"
+
+namespace mdo {
+
+//!
+//! Resumes the coroutine by posting a message to the 'target' object, i.e. in
+//! the thread or the strand of the object. If the message is rejected or is
+//! destroyed without being handled, e.g. the target is dead, the coroutine
+//! frame is destroyed instead of being resumed.
+//!
+//! Returns the error of Dispatcher::Dispatch.
+//!
+std::error_code ResumeOn(const ObjectHandle& target, std::coroutine_handle<> handle);
+
+//!
+//! Returns the object which should resume a coroutine suspended in the
+//! calling thread: the object whose message is being handled or the current
+//! Thread object if the coroutine was started outside of a message handler.
+//!
+Object* ResumptionTarget() noexcept;
+
+//!
+//! Awaitable suspending the coroutine for the specified time without blocking
+//! the thread. It's backed by a single shot timer of TimerService.
+//!
+class SleepAwaitable final {
+ public:
+  explicit SleepAwaitable(const std::chrono::nanoseconds& duration);
+  ~SleepAwaitable();
+
+  bool await_ready() const noexcept;
+  void await_suspend(std::coroutine_handle<> handle);
+  void await_resume() const noexcept {}
+
+ private:
+  class Waker;
+
+  std::chrono::nanoseconds duration_;
+  std::unique_ptr<Waker> waker_;
+};
+
+SleepAwaitable Sleep(const std::chrono::nanoseconds& duration);
+
+}// namespace mdo
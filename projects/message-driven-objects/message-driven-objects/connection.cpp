@@ -0,0 +1,42 @@
+#include "connection.h"
+
+namespace mdo {
+
+Connection::Connection(std::weak_ptr<details::ConnectionControl> control) noexcept
+    : control_{std::move(control)} {}
+
+void Connection::Disconnect() noexcept {
+  if (const auto control = control_.lock()) {
+    control->connected.store(false, std::memory_order_release);
+  }
+
+  control_.reset();
+}
+
+bool Connection::IsConnected() const noexcept {
+  const auto control = control_.lock();
+  return control && control->IsConnected();
+}
+
+ScopedConnection::ScopedConnection(Connection connection) noexcept
+    : connection_{std::move(connection)} {}
+
+ScopedConnection::ScopedConnection(ScopedConnection&& other) noexcept
+    : connection_{other.Release()} {}
+
+ScopedConnection& ScopedConnection::operator=(ScopedConnection&& other) noexcept {
+  if (this != &other) {
+    connection_.Disconnect();
+    connection_ = other.Release();
+  }
+
+  return *this;
+}
+
+ScopedConnection::~ScopedConnection() { connection_.Disconnect(); }
+
+Connection ScopedConnection::Release() noexcept { return std::exchange(connection_, {}); }
+
+bool ScopedConnection::IsConnected() const noexcept { return connection_.IsConnected(); }
+
+}// namespace mdo
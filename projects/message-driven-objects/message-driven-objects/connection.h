@@ -0,0 +1,79 @@
+#pragma once
+
+#include "objects_registry.h"
+
+namespace mdo {
+
+namespace details {
+
+//
+// state of a signal connection shared by the signal and the Connection handles
+//
+struct ConnectionControl {
+  explicit ConnectionControl(const ObjectHandle& receiver) noexcept
+      : connected{true},
+        receiver{receiver} {}
+
+  bool IsConnected() const noexcept {
+    return connected.load(std::memory_order_acquire) && (!receiver || receiver.IsAlive());
+  }
+
+  std::atomic_bool connected;
+
+  //
+  // invalid for the function slots
+  //
+  ObjectHandle receiver;
+};
+
+}// namespace details
+
+//!
+//! Handle of a signal connection returned by Signal::Connect.
+//!
+//! The connection is disconnected automatically when its receiver is
+//! destroyed. Disconnecting doesn't wait for the emits running in other
+//! threads and doesn't cancel the emits already posted to the receiver's
+//! thread.
+//!
+class Connection {
+ public:
+  Connection() = default;
+  explicit Connection(std::weak_ptr<details::ConnectionControl> control) noexcept;
+
+  void Disconnect() noexcept;
+
+  [[nodiscard]] bool IsConnected() const noexcept;
+
+ private:
+  std::weak_ptr<details::ConnectionControl> control_;
+};
+
+//!
+//! Disconnects the connection when goes out of scope.
+//!
+class ScopedConnection {
+ public:
+  ScopedConnection() = default;
+  ScopedConnection(Connection connection) noexcept;
+
+  ScopedConnection(ScopedConnection&& other) noexcept;
+  ScopedConnection& operator=(ScopedConnection&& other) noexcept;
+
+  ScopedConnection(const ScopedConnection& other) = delete;
+  ScopedConnection& operator=(const ScopedConnection& other) = delete;
+
+  ~ScopedConnection();
+
+  //!
+  //! Returns the connection which stays connected after this object dies.
+  //!
+  Connection Release() noexcept;
+
+  [[nodiscard]] bool IsConnected() const noexcept;
+
+ private:
+  Connection connection_;
+};
+
+}// namespace mdo
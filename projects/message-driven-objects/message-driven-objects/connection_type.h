@@ -0,0 +1,30 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Defines how a Signal calls the slot of a receiver object.
+//!
+enum class ConnectionType : uint8_t {
+  //!
+  //! The slot is called directly if the receiver lives in the emitting
+  //! thread, otherwise the emit is posted to the receiver's thread. The
+  //! thread affinity of the receiver is cached when the signal is connected.
+  //! The receiver is pinned during the direct call the same as with kDirect.
+  //!
+  kAuto,
+
+  //!
+  //! The slot is always called in the emitting thread. The receiver is
+  //! pinned during the call, so it can't be retired by another thread.
+  //!
+  kDirect,
+
+  //!
+  //! The emit is always posted to the receiver's thread, even if it is the
+  //! emitting thread.
+  //!
+  kQueued
+};
+
+}// namespace mdo
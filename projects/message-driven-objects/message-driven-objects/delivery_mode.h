@@ -0,0 +1,30 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Defines how the emits of a Signal are delivered to a receiver living in
+//! another thread. The receiver living in the emitting thread is always
+//! called directly.
+//!
+enum class DeliveryMode : uint8_t {
+  //!
+  //! Each emit posts its own message to the receiver.
+  //!
+  kQueued,
+
+  //!
+  //! Latest value wins: at most one message per connection is pending, the
+  //! emits made before the receiver handles it replace the arguments of the
+  //! previous ones.
+  //!
+  kCoalesced,
+
+  //!
+  //! At most one message per connection is pending, the emits made before
+  //! the receiver handles it are accumulated and delivered together.
+  //!
+  kBatched
+};
+
+}// namespace mdo
@@ -1,6 +1,8 @@
 #include "dispatcher.h"
 
 #include "thread.h"
+#include "thread_pool.h"
+#include "trace.h"
 
 namespace mdo {
 
@@ -39,18 +41,98 @@ void Dispatcher::Quit() {
   thread->Started.DisconnectAll();
 }
 
-void Dispatcher::Dispatch(Message&& message) {
+std::error_code Dispatcher::Dispatch(Message&& message) {
+  const auto priority = DefaultPriority(message);
+  return Dispatch(std::move(message), priority);
+}
+
+std::error_code Dispatcher::Dispatch(Message&& message, MessagePriority priority) {
   if (Instance().Thread()->IsInterruptionRequested()) {
-    return;
+    return std::make_error_code(std::errc::operation_canceled);
+  }
+
+  MDO_TRACE_DISPATCHED(message);
+
+  //
+  // the receiver can't be retired while its thread is being read
+  //
+  const ObjectPin pin{std::visit(GetReceiverHandle, message)};
+  const auto receiver = pin.Get();
+
+  if (!receiver) {
+    LOG_TRACE("the receiver of the message is dead so the message is dropped");
+    return std::make_error_code(std::errc::identifier_removed);
   }
 
-  const auto receiver_thread = std::visit(GetReceiver, message)->Thread();
+  if (const auto pool = receiver->Pool()) {
+    LOG_TRACE("dispatching message for thread pool '{}'", (void*) pool);
+    return pool->Post(std::move(message));
+  }
+
+  const auto receiver_thread = receiver->Thread();
 
   LOG_TRACE("dispatching message for thread '{}'", receiver_thread->Name());
 
   const auto data = GetThreadData(receiver_thread);
 
-  data->Queue().Post(std::move(message));
+  return data->Queue().Post(std::move(message), priority);
+}
+
+std::error_code Dispatcher::Dispatch(std::vector<Message>& messages, MessagePriority priority) {
+  if (Instance().Thread()->IsInterruptionRequested()) {
+    messages.clear();
+    return std::make_error_code(std::errc::operation_canceled);
+  }
+
+  //
+  // usually there are only a few receiver threads, so the linear search is
+  // cheaper than hashing
+  //
+  std::vector<std::pair<mdo::Thread*, std::vector<Message>>> batches;
+  std::error_code error;
+
+  for (auto& message : messages) {
+    MDO_TRACE_DISPATCHED(message);
+
+    const ObjectPin pin{std::visit(GetReceiverHandle, message)};
+    const auto receiver = pin.Get();
+
+    if (!receiver) {
+      continue;
+    }
+
+    if (const auto pool = receiver->Pool()) {
+      if (const auto pool_error = pool->Post(std::move(message))) {
+        error = pool_error;
+      }
+
+      continue;
+    }
+
+    const auto receiver_thread = receiver->Thread();
+
+    auto it = std::find_if(batches.begin(), batches.end(), [receiver_thread](const auto& batch) {
+      return batch.first == receiver_thread;
+    });
+
+    if (it == batches.end()) {
+      it = batches.emplace(batches.end(), receiver_thread, std::vector<Message>{});
+    }
+
+    it->second.push_back(std::move(message));
+  }
+
+  messages.clear();
+
+  for (auto& [receiver_thread, batch] : batches) {
+    LOG_TRACE("dispatching '{}' messages for thread '{}'", batch.size(), receiver_thread->Name());
+
+    if (const auto batch_error = GetThreadData(receiver_thread)->Queue().Post(batch, priority)) {
+      error = batch_error;
+    }
+  }
+
+  return error;
 }
 
 }// namespace mdo
\ No newline at end of file
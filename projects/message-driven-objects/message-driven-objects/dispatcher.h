@@ -14,7 +14,33 @@ class Dispatcher : public Object {
   std::error_code Exec();
 
   static void Quit();
-  static void Dispatch(Message&& message);
+  //!
+  //! Posts the message to the queue of the receiver's thread using
+  //! DefaultPriority(message) lane.
+  //!
+  //! Returns the error of MessageQueue::Post or ThreadPool::Post if the
+  //! receiver's queue rejected the message or std::errc::operation_canceled
+  //! if the dispatcher is stopping.
+  //!
+  static std::error_code Dispatch(Message&& message);
+
+  //!
+  //! Posts the message to the queue of the receiver's thread using the lane
+  //! of the specified priority.
+  //! Objects bound to a ThreadPool receive the messages in the posting order
+  //! regardless of the priority.
+  //!
+  static std::error_code Dispatch(Message&& message, MessagePriority priority);
+
+  //!
+  //! Posts the messages to the lane of the specified priority, the messages
+  //! to the same thread are posted as one batch (see MessageQueue::Post).
+  //! The vector is cleared.
+  //!
+  //! Returns the last error of posting or std::errc::operation_canceled if
+  //! the dispatcher is stopping.
+  //!
+  static std::error_code Dispatch(std::vector<Message>& messages, MessagePriority priority);
 
  private:
   Dispatcher() = default;
@@ -0,0 +1,99 @@
+#include "emit_epochs.h"
+
+#include "metrics.h"
+
+namespace {
+
+constexpr uint64_t kIdle = std::numeric_limits<uint64_t>::max();
+
+std::atomic_uint64_t global_epoch{0};
+
+//
+// the epoch the thread has entered or kIdle, written only by its thread
+//
+struct alignas(mdo::details::kCacheLineSize) EpochRecord {
+  EpochRecord();
+  ~EpochRecord();
+
+  std::atomic_uint64_t epoch{kIdle};
+  size_t nesting{};
+};
+
+struct EpochRecords {
+  std::mutex mutex;
+  std::vector<const EpochRecord*> records;
+};
+
+//
+// the records of the threads which exit after the static objects are
+// destroyed unregister themselves too, so the list is never destroyed
+//
+EpochRecords& Records() {
+  static const auto records = new EpochRecords{};
+  return *records;
+}
+
+EpochRecord::EpochRecord() {
+  auto& records = Records();
+
+  std::scoped_lock _{records.mutex};
+  records.records.push_back(this);
+}
+
+EpochRecord::~EpochRecord() {
+  auto& records = Records();
+
+  std::scoped_lock _{records.mutex};
+  std::erase(records.records, this);
+}
+
+thread_local EpochRecord current_record;
+
+}// namespace
+
+namespace mdo {
+
+namespace details {
+
+void EmitEpochs::Enter() {
+  auto& record = current_record;
+
+  if (record.nesting++ != 0) {
+    return;
+  }
+
+  //
+  // the record is published before the snapshot is loaded, so either the
+  // retiring thread sees the record or the emit loads the new snapshot
+  //
+  record.epoch.store(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void EmitEpochs::Leave() noexcept {
+  auto& record = current_record;
+
+  if (--record.nesting == 0) {
+    record.epoch.store(kIdle, std::memory_order_release);
+  }
+}
+
+uint64_t EmitEpochs::Retire() noexcept {
+  return global_epoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+uint64_t EmitEpochs::OldestActive() {
+  auto oldest = global_epoch.load(std::memory_order_seq_cst);
+  auto& records = Records();
+
+  std::scoped_lock _{records.mutex};
+
+  for (const auto record : records.records) {
+    oldest = std::min(oldest, record->epoch.load(std::memory_order_seq_cst));
+  }
+
+  return oldest;
+}
+
+}// namespace details
+
+}// namespace mdo
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace mdo {
+
+namespace details {
+
+//
+// Epoch based reclamation of the connection snapshots of the signals.
+//
+// An emit publishes the global epoch in the record of its thread before it
+// reads a snapshot and clears the record when it's done, so the emitting
+// threads write only their own cache lines. A replaced snapshot is tagged
+// with the epoch it was retired in and can be deleted once every thread is
+// either idle or has entered a later epoch, i.e. as soon as the emits which
+// could read the snapshot are finished, whatever the other emits do.
+//
+class EmitEpochs final {
+ public:
+  //
+  // marks the calling thread as reading the snapshots, the calls nest
+  //
+  static void Enter();
+  static void Leave() noexcept;
+
+  //
+  // advances the epoch, must be called after the snapshot is replaced;
+  // returns the epoch the replaced snapshot is tagged with
+  //
+  static uint64_t Retire() noexcept;
+
+  //
+  // returns the oldest epoch an emit in progress may read in, the snapshots
+  // tagged with an earlier epoch can be deleted
+  //
+  static uint64_t OldestActive();
+};
+
+}// namespace details
+
+}// namespace mdo
@@ -0,0 +1,178 @@
+#include "future.h"
+
+#include "atomic_helpers.h"
+#include "wait_primitives.h"
+
+namespace mdo {
+
+namespace details {
+
+//
+// The reference of the continuation message to the slot. The message either
+// runs the continuation or, if it's destroyed without being handled (e.g. it
+// was rejected, the target is dead or its thread was stopped), destroys the
+// continuation and releases the reference the continuation owns.
+//
+class CompletionSlotBase::ContinuationReference final {
+ public:
+  explicit ContinuationReference(CompletionSlotBase* slot) noexcept : slot_{slot} {}
+
+  ContinuationReference(ContinuationReference&& other) noexcept : slot_{std::exchange(other.slot_, nullptr)} {}
+
+  ContinuationReference(const ContinuationReference&) = delete;
+  ContinuationReference& operator=(const ContinuationReference&) = delete;
+
+  ~ContinuationReference() {
+    if (slot_) {
+      slot_->DropContinuation();
+    }
+  }
+
+  void Run() { std::exchange(slot_, nullptr)->RunContinuation(); }
+
+ private:
+  CompletionSlotBase* slot_;
+};
+
+void CompletionSlotBase::AddRef() noexcept {
+  references_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CompletionSlotBase::Release() noexcept {
+  if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Recycle();
+  }
+}
+
+bool CompletionSlotBase::IsReady() const noexcept { return LoadAcquire(state_) == kReady; }
+
+void CompletionSlotBase::Wait() noexcept {
+  //
+  // the waiting state tells the producer to wake the thread up, otherwise
+  // the completion doesn't make the system call
+  //
+  auto expected = uint32_t{kPending};
+  state_.compare_exchange_strong(expected, kWaiting, std::memory_order_acq_rel);
+
+  while (LoadAcquire(state_) != kReady) {
+    WaitWhileEqual(state_, kWaiting);
+  }
+}
+
+bool CompletionSlotBase::SetContinuation(Object* target,
+                                         UniqueFunction<void()>&& continuation,
+                                         bool owns_reference) {
+  continuation_ = std::move(continuation);
+  continuation_owns_reference_ = owns_reference;
+
+  return ArmContinuation(target);
+}
+
+bool CompletionSlotBase::SetContinuation(Object* target, std::coroutine_handle<> coroutine) {
+  coroutine_ = coroutine;
+
+  return ArmContinuation(target);
+}
+
+void CompletionSlotBase::OnCompleted() {
+  const auto previous = state_.exchange(kReady, std::memory_order_acq_rel);
+
+  if (previous == kWaiting) {
+    WakeAll(state_);
+  }
+
+  if (previous != kContinuation) {
+    return;
+  }
+
+  //
+  // the lambda captures only the reference, so it's stored in the message
+  // without an allocation. A rejected message is destroyed by the end of the
+  // statement, which drops the continuation.
+  //
+  const auto error = Dispatcher::Dispatch(InvokeSlotMessage{
+    [reference = ContinuationReference{this}]() mutable { reference.Run(); },
+    ObjectHandle{},
+    continuation_target_});
+
+  if (error) {
+    LOG_WARNING("failed to dispatch the continuation: {}", error.message());
+  }
+}
+
+void CompletionSlotBase::ResetBase() noexcept {
+  StoreRelaxed(state_, uint32_t{kPending});
+  continuation_target_ = {};
+  continuation_ = nullptr;
+  coroutine_ = {};
+  continuation_owns_reference_ = false;
+}
+
+bool CompletionSlotBase::ArmContinuation(Object* target) {
+  //
+  // the handle is taken while the target is surely alive, the continuation
+  // message is dispatched to the handle, so the target may die meanwhile
+  //
+  continuation_target_ = target->Handle();
+
+  auto expected = uint32_t{kPending};
+
+  if (state_.compare_exchange_strong(expected, kContinuation, std::memory_order_acq_rel)) {
+    return true;
+  }
+
+  continuation_target_ = {};
+  continuation_ = nullptr;
+  coroutine_ = {};
+
+  return false;
+}
+
+void CompletionSlotBase::RunContinuation() {
+  //
+  // the awaiting coroutine may release the slot when it's resumed, so the
+  // slot isn't touched after the call unless the continuation owns the
+  // reference
+  //
+  auto continuation = std::move(continuation_);
+  const auto coroutine = std::exchange(coroutine_, {});
+  const auto owns_reference = continuation_owns_reference_;
+
+  continuation_ = nullptr;
+
+  if (coroutine) {
+    coroutine.resume();
+  } else {
+    continuation();
+  }
+
+  if (owns_reference) {
+    Release();
+  }
+}
+
+void CompletionSlotBase::DropContinuation() noexcept {
+  //
+  // destroying the continuation or the coroutine frame owning the awaiter
+  // may release the last reference of the consumer, so the slot isn't
+  // touched after it either
+  //
+  auto continuation = std::move(continuation_);
+  const auto coroutine = std::exchange(coroutine_, {});
+  const auto owns_reference = continuation_owns_reference_;
+
+  continuation_ = nullptr;
+  continuation = nullptr;
+
+  if (coroutine) {
+    coroutine.destroy();
+  }
+
+  if (owns_reference) {
+    Release();
+  }
+}
+
+}// namespace details
+
+}// namespace mdo
@@ -0,0 +1,429 @@
+#pragma once
+
+#include "awaitables.h"
+#include "dispatcher.h"
+#include "message.h"
+#include "object.h"
+
+namespace mdo {
+
+namespace details {
+
+//!
+//! The part of the completion slot which doesn't depend on the result type:
+//! the state, the references and the continuation.
+//!
+//! The slot is shared by the consumer (Future, its awaiter or its
+//! continuation) and the producer (the message invoking the method). When
+//! the producer is gone without completing the slot, e.g. the message was
+//! dropped because the receiver was destroyed or its thread was stopped, the
+//! slot is completed with std::errc::operation_canceled.
+//!
+class CompletionSlotBase {
+ public:
+  virtual ~CompletionSlotBase() = default;
+
+  void AddRef() noexcept;
+  void Release() noexcept;
+
+  [[nodiscard]] bool IsReady() const noexcept;
+
+  //!
+  //! Blocks until the slot is completed.
+  //!
+  void Wait() noexcept;
+
+  //!
+  //! Registers the continuation to be called in the thread of the 'target'
+  //! when the slot is completed. If 'owns_reference' is set, the reference of
+  //! the consumer is released after the call.
+  //!
+  //! Returns false without registering if the slot is already completed.
+  //!
+  bool SetContinuation(Object* target, UniqueFunction<void()>&& continuation, bool owns_reference);
+
+  //!
+  //! Registers the coroutine to be resumed in the thread of the 'target' when
+  //! the slot is completed. If the message resuming the coroutine is
+  //! destroyed without being handled, e.g. the target is dead, the coroutine
+  //! frame is destroyed instead.
+  //!
+  //! Returns false without registering if the slot is already completed.
+  //!
+  bool SetContinuation(Object* target, std::coroutine_handle<> coroutine);
+
+  //!
+  //! Completes the slot with the error if it isn't completed yet.
+  //!
+  virtual void Cancel(const std::error_code& error) = 0;
+
+ protected:
+  //!
+  //! Called by the producer after storing the result.
+  //!
+  void OnCompleted();
+
+  //!
+  //! Returns the slot to its pool, called when the last reference is gone.
+  //!
+  virtual void Recycle() noexcept = 0;
+
+  void ResetBase() noexcept;
+
+ private:
+  class ContinuationReference;
+
+  bool ArmContinuation(Object* target);
+  void RunContinuation();
+  void DropContinuation() noexcept;
+
+ private:
+  enum State : uint32_t { kPending, kWaiting, kContinuation, kReady };
+
+  std::atomic_uint32_t state_{kPending};
+  std::atomic_uint32_t references_{0};
+
+  ObjectHandle continuation_target_;
+  UniqueFunction<void()> continuation_;
+  std::coroutine_handle<> coroutine_;
+  bool continuation_owns_reference_{};
+};
+
+template <typename R>
+class CompletionSlot : public CompletionSlotBase {
+ public:
+  using Result = tl::expected<R, std::error_code>;
+
+  void Complete(Result&& result) {
+    result_.emplace(std::move(result));
+    OnCompleted();
+  }
+
+  Result Take() { return std::move(*result_); }
+
+  void Cancel(const std::error_code& error) override {
+    if (!IsReady()) {
+      Complete(tl::unexpected{error});
+    }
+  }
+
+ protected:
+  void Reset() noexcept {
+    result_.reset();
+    ResetBase();
+  }
+
+ private:
+  std::optional<Result> result_;
+};
+
+//!
+//! The reference of the producer to the slot, it's moved along with the
+//! message invoking the method and cancels the slot if the message is
+//! destroyed without being handled.
+//!
+template <typename Slot>
+class ProducerReference final {
+ public:
+  explicit ProducerReference(Slot* slot) noexcept : slot_{slot} { slot_->AddRef(); }
+
+  ProducerReference(ProducerReference&& other) noexcept : slot_{std::exchange(other.slot_, nullptr)} {}
+
+  ProducerReference(const ProducerReference&) = delete;
+  ProducerReference& operator=(const ProducerReference&) = delete;
+
+  ~ProducerReference() {
+    if (slot_) {
+      slot_->Cancel(std::make_error_code(std::errc::operation_canceled));
+      slot_->Release();
+    }
+  }
+
+  Slot* operator->() const noexcept { return slot_; }
+
+ private:
+  Slot* slot_;
+};
+
+//!
+//! Per thread cache of the free slots of the type T. A slot is taken from
+//! the cache of the thread which calls Invoke() and returned to the cache of
+//! the thread which releases it last, in the steady state of a
+//! request/reply exchange no slot is allocated.
+//!
+template <typename T>
+class SlotPool final {
+ public:
+  static constexpr size_t kMaxCachedSlots = 64;
+
+  static T* Acquire() {
+    auto& cache = Cache();
+
+    if (cache.empty()) {
+      return new T{};
+    }
+
+    const auto slot = cache.back().release();
+    cache.pop_back();
+    return slot;
+  }
+
+  static void Put(T* slot) noexcept {
+    auto& cache = Cache();
+
+    if (cache.size() < kMaxCachedSlots) {
+      cache.emplace_back(slot);
+    } else {
+      delete slot;
+    }
+  }
+
+ private:
+  static std::vector<std::unique_ptr<T>>& Cache() {
+    thread_local std::vector<std::unique_ptr<T>> cache = [] {
+      std::vector<std::unique_ptr<T>> result;
+      result.reserve(kMaxCachedSlots);
+      return result;
+    }();
+
+    return cache;
+  }
+};
+
+//!
+//! The pooled slot which also keeps the call: the object, the method and
+//! the arguments.
+//!
+template <typename ObjectType, typename Method, typename... Args>
+class Invocation final : public CompletionSlot<std::invoke_result_t<Method, ObjectType*, Args...>> {
+ public:
+  using Value = std::invoke_result_t<Method, ObjectType*, Args...>;
+
+  template <typename... CallArgs>
+  static Invocation* Create(ObjectType* object, Method method, CallArgs&&... args) {
+    const auto invocation = SlotPool<Invocation>::Acquire();
+
+    invocation->object_ = object;
+    invocation->method_ = method;
+    invocation->args_.emplace(std::forward<CallArgs>(args)...);
+    invocation->AddRef();
+
+    return invocation;
+  }
+
+  void Run() {
+    auto call = [this](auto&&... args) { return std::invoke(method_, object_, std::move(args)...); };
+    auto args = std::move(*args_);
+
+    args_.reset();
+
+    if constexpr (std::is_void_v<Value>) {
+      std::apply(call, args);
+      this->Complete({});
+    } else {
+      this->Complete(std::apply(call, args));
+    }
+  }
+
+ protected:
+  void Recycle() noexcept override {
+    object_ = nullptr;
+    args_.reset();
+    this->Reset();
+    SlotPool<Invocation>::Put(this);
+  }
+
+ private:
+  ObjectType* object_{};
+  Method method_{};
+  std::optional<std::tuple<Args...>> args_;
+};
+
+}// namespace details
+
+//!
+//! The result of the asynchronous call made by Invoke(), completed in the
+//! thread of the called object. The result is consumed once, by one of:
+//!
+//!   - Get() blocking the calling thread,
+//!   - Then() calling the continuation in the calling thread,
+//!   - co_await resuming the coroutine in the calling thread.
+//!
+//! The result is tl::expected holding the method's result or the error if
+//! the call couldn't be made, e.g. the object is destroyed.
+//!
+//! Unlike std::future there is no shared state allocated per call: the state
+//! lives in a slot taken from a per thread pool.
+//!
+template <typename R>
+class Future final {
+ public:
+  using Result = tl::expected<R, std::error_code>;
+
+  Future() noexcept = default;
+
+  explicit Future(details::CompletionSlot<R>* slot) noexcept : slot_{slot} {}
+
+  Future(Future&& other) noexcept : slot_{std::exchange(other.slot_, nullptr)} {}
+
+  Future& operator=(Future&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      slot_ = std::exchange(other.slot_, nullptr);
+    }
+
+    return *this;
+  }
+
+  Future(const Future&) = delete;
+  Future& operator=(const Future&) = delete;
+
+  ~Future() { Reset(); }
+
+  //!
+  //! Returns false if the result is already consumed.
+  //!
+  [[nodiscard]] bool Valid() const noexcept { return slot_; }
+
+  [[nodiscard]] bool IsReady() const noexcept { return slot_ && slot_->IsReady(); }
+
+  //!
+  //! Blocks until the result is ready and returns it. Must not be called in
+  //! the thread of the called object, the call would never be handled.
+  //!
+  Result Get() {
+    assert(slot_);
+
+    slot_->Wait();
+    auto result = slot_->Take();
+    Reset();
+
+    return result;
+  }
+
+  //!
+  //! Calls f(Result) in the calling thread (or the strand) when the result
+  //! is ready. The calling thread must run the event loop.
+  //!
+  template <typename F>
+  void Then(F&& f) && {
+    assert(slot_);
+
+    const auto slot = std::exchange(slot_, nullptr);
+    auto continuation = [slot, f = std::forward<F>(f)]() mutable { f(slot->Take()); };
+
+    if (!slot->SetContinuation(ResumptionTarget(), std::move(continuation), true)) {
+      f(slot->Take());
+      slot->Release();
+    }
+  }
+
+  class Awaiter final {
+   public:
+    explicit Awaiter(details::CompletionSlot<R>* slot) noexcept : slot_{slot} {}
+
+    Awaiter(const Awaiter&) = delete;
+    Awaiter& operator=(const Awaiter&) = delete;
+
+    ~Awaiter() { slot_->Release(); }
+
+    bool await_ready() const noexcept { return slot_->IsReady(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return slot_->SetContinuation(ResumptionTarget(), handle);
+    }
+
+    Result await_resume() { return slot_->Take(); }
+
+   private:
+    details::CompletionSlot<R>* slot_;
+  };
+
+  //!
+  //! Resumes the coroutine in its own thread (or strand) with the result.
+  //! If the object which awaits is destroyed before the result is ready,
+  //! the coroutine frame is destroyed without being resumed.
+  //!
+  Awaiter operator co_await() && noexcept {
+    assert(slot_);
+    return Awaiter{std::exchange(slot_, nullptr)};
+  }
+
+ private:
+  void Reset() noexcept {
+    if (slot_) {
+      std::exchange(slot_, nullptr)->Release();
+    }
+  }
+
+ private:
+  details::CompletionSlot<R>* slot_{};
+};
+
+//!
+//! Invokes object->method(args...) in the thread of the object and returns
+//! the future of the result. Arguments are copied or moved into the pooled
+//! slot and moved into the method.
+//!
+//!   auto balance = Invoke(accounts_, &Accounts::Balance, user_).Get();
+//!
+//!   Invoke(accounts_, &Accounts::Balance, user_).Then([this](auto balance) {
+//!     ...
+//!   });
+//!
+//!   Task Session::OnRequest() {
+//!     const auto balance = co_await Invoke(accounts_, &Accounts::Balance, user_);
+//!     ...
+//!   }
+//!
+template <typename ObjectType, typename Method, typename... Args>
+auto Invoke(ObjectType* object, Method method, Args&&... args) {
+  static_assert(std::is_base_of_v<Object, ObjectType>,
+                "ObjectType must be derived from class Object");
+
+  using Invocation = details::Invocation<ObjectType, Method, std::decay_t<Args>...>;
+
+  const auto invocation = Invocation::Create(object, method, std::forward<Args>(args)...);
+  Future<typename Invocation::Value> future{invocation};
+
+  //
+  // the closure holds only the reference, so it's stored in the message
+  // without an allocation
+  //
+  Message message{InvokeSlotMessage{
+    [producer = details::ProducerReference{invocation}] { producer->Run(); },
+    Object::Current(),
+    object}};
+
+  //
+  // a rejected message is destroyed at the end of the scope, so the slot is
+  // completed with the actual error before the message cancels it
+  //
+  if (const auto error = Dispatcher::Dispatch(std::move(message)); error && !invocation->IsReady()) {
+    invocation->Complete(tl::unexpected{error});
+  }
+
+  return future;
+}
+
+//!
+//! Invoke() meant to be awaited: the method is called in the thread of the
+//! object and the awaiting coroutine is resumed in its own thread with the
+//! result or the error if the call couldn't be made.
+//!
+//!   Task Session::OnLogon() {
+//!     const auto allowed = co_await CallAsync(storage_, &Storage::CheckUser, user_);
+//!
+//!     if (!allowed) {
+//!       LOG_WARNING("failed to check the user: {}", allowed.error().message());
+//!       co_return;
+//!     }
+//!     ...
+//!   }
+//!
+template <typename ObjectType, typename Method, typename... Args>
+auto CallAsync(ObjectType* object, Method method, Args&&... args) {
+  return Invoke(object, method, std::forward<Args>(args)...);
+}
+
+}// namespace mdo
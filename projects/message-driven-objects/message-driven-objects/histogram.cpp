@@ -0,0 +1,119 @@
+#include "histogram.h"
+
+namespace mdo {
+
+namespace {
+
+constexpr size_t kHalfSubBucketCount = Histogram::kSubBucketCount / 2;
+
+}// namespace
+
+Histogram::Histogram() noexcept { Reset(); }
+
+size_t Histogram::BucketIndex(uint64_t value) noexcept {
+  value = std::min(value, kMaxValue);
+
+  if (value < kSubBucketCount) {
+    return static_cast<size_t>(value);
+  }
+
+  //
+  // the top kSubBucketBits bits of the value select the linear bucket
+  // within its power of two range
+  //
+  const auto shift = static_cast<size_t>(std::bit_width(value)) - kSubBucketBits;
+  const auto top = static_cast<size_t>(value >> shift);
+
+  return kSubBucketCount + (shift - 1) * kHalfSubBucketCount + (top - kHalfSubBucketCount);
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index) noexcept {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+
+  const auto offset = index - kSubBucketCount;
+  const auto shift = offset / kHalfSubBucketCount + 1;
+  const auto top = uint64_t{kHalfSubBucketCount + offset % kHalfSubBucketCount};
+
+  return ((top + 1) << shift) - 1;
+}
+
+void Histogram::Record(const std::chrono::nanoseconds& value) noexcept {
+  const auto ns = std::min(static_cast<uint64_t>(std::max<int64_t>(value.count(), 0)), kMaxValue);
+
+  ++counts_[BucketIndex(ns)];
+  ++count_;
+  sum_ += ns;
+  min_ = std::min(min_, ns);
+  max_ = std::max(max_, ns);
+}
+
+void Histogram::RecordBucket(size_t index, uint64_t count) noexcept {
+  if (!count) {
+    return;
+  }
+
+  const auto lower = index ? BucketUpperBound(index - 1) + 1 : 0;
+  const auto upper = BucketUpperBound(index);
+
+  counts_[index] += count;
+  count_ += count;
+  sum_ += (lower + upper) / 2 * count;
+  min_ = std::min(min_, lower);
+  max_ = std::max(max_, upper);
+}
+
+void Histogram::Merge(const Histogram& other) noexcept {
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void Histogram::Reset() noexcept {
+  counts_.fill(0);
+  count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<uint64_t>::max();
+  max_ = 0;
+}
+
+uint64_t Histogram::Count() const noexcept { return count_; }
+
+std::chrono::nanoseconds Histogram::Min() const noexcept {
+  return std::chrono::nanoseconds{count_ ? min_ : 0};
+}
+
+std::chrono::nanoseconds Histogram::Max() const noexcept {
+  return std::chrono::nanoseconds{max_};
+}
+
+std::chrono::nanoseconds Histogram::Mean() const noexcept {
+  return std::chrono::nanoseconds{count_ ? sum_ / count_ : 0};
+}
+
+std::chrono::nanoseconds Histogram::Percentile(double p) const noexcept {
+  if (!count_) {
+    return {};
+  }
+
+  const auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(static_cast<double>(count_) * p / 100.0)), 1);
+  uint64_t seen = 0;
+
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += counts_[i];
+
+    if (seen >= rank) {
+      return std::chrono::nanoseconds{std::clamp<uint64_t>(BucketUpperBound(i), min_, max_)};
+    }
+  }
+
+  return Max();
+}
+
+}// namespace mdo
@@ -0,0 +1,71 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! HDR-style log-linear histogram of durations with constant memory and O(1)
+//! recording.
+//!
+//! The values below kSubBucketCount nanoseconds are counted exactly, each
+//! next power of two range is split into kSubBucketCount / 2 linear buckets,
+//! so a value is reported with a relative error below 2 / kSubBucketCount
+//! (1.6%). The values above kMaxValue are counted as kMaxValue.
+//!
+//! The histogram isn't thread-safe: each thread records into its own
+//! histogram and the histograms are merged when the result is needed.
+//!
+class Histogram {
+ public:
+  static constexpr size_t kSubBucketBits = 7;
+  static constexpr size_t kSubBucketCount = size_t{1} << kSubBucketBits;
+  static constexpr size_t kMaxValueBits = 40;
+  static constexpr uint64_t kMaxValue = (uint64_t{1} << kMaxValueBits) - 1;
+  static constexpr size_t kBucketCount =
+    kSubBucketCount + (kMaxValueBits - kSubBucketBits) * (kSubBucketCount / 2);
+
+  Histogram() noexcept;
+
+  //!
+  //! Returns the index of the bucket counting the value in nanoseconds.
+  //!
+  static size_t BucketIndex(uint64_t value) noexcept;
+
+  //!
+  //! Returns the max value counted by the bucket.
+  //!
+  static uint64_t BucketUpperBound(size_t index) noexcept;
+
+  void Record(const std::chrono::nanoseconds& value) noexcept;
+
+  //!
+  //! Adds the count to the bucket, used to build the histogram from the
+  //! counters maintained elsewhere. The min and the max are estimated by the
+  //! bucket bounds.
+  //!
+  void RecordBucket(size_t index, uint64_t count) noexcept;
+
+  void Merge(const Histogram& other) noexcept;
+
+  void Reset() noexcept;
+
+  [[nodiscard]] uint64_t Count() const noexcept;
+  [[nodiscard]] std::chrono::nanoseconds Min() const noexcept;
+  [[nodiscard]] std::chrono::nanoseconds Max() const noexcept;
+  [[nodiscard]] std::chrono::nanoseconds Mean() const noexcept;
+
+  //!
+  //! Returns the value below which the percentile p (0-100) of the recorded
+  //! values falls, i.e. the upper bound of the bucket containing it, but not
+  //! more than Max().
+  //!
+  [[nodiscard]] std::chrono::nanoseconds Percentile(double p) const noexcept;
+
+ private:
+  std::array<uint64_t, kBucketCount> counts_;
+  uint64_t count_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+};
+
+}// namespace mdo
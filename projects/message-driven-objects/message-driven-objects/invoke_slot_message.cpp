@@ -2,12 +2,18 @@
 
 namespace mdo {
 
-InvokeSlotMessage::InvokeSlotMessage(const std::function<void()>& f,
+InvokeSlotMessage::InvokeSlotMessage(UniqueFunction<void()> f,
                                      Object* sender,
                                      Object* receiver)
     : MessageBase{sender, receiver},
-      f_{f} {}
+      f_{std::move(f)} {}
 
-void InvokeSlotMessage::Invoke() const { f_(); }
+InvokeSlotMessage::InvokeSlotMessage(UniqueFunction<void()> f,
+                                     const ObjectHandle& sender,
+                                     const ObjectHandle& receiver)
+    : MessageBase{sender, receiver},
+      f_{std::move(f)} {}
+
+void InvokeSlotMessage::Invoke() { f_(); }
 
 }// namespace mdo
\ No newline at end of file
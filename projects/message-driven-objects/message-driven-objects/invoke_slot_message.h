@@ -1,17 +1,23 @@
 #pragma once
 
 #include "message_base.h"
+#include "unique_function.h"
 
 namespace mdo {
 
+//!
+//! Message calling the function in the thread of the receiver. The function
+//! is moved along with the message, so it may own move-only arguments.
+//!
 class InvokeSlotMessage : public MessageBase {
  public:
-  InvokeSlotMessage(const std::function<void()>& f, Object* sender, Object* receiver);
+  InvokeSlotMessage(UniqueFunction<void()> f, Object* sender, Object* receiver);
+  InvokeSlotMessage(UniqueFunction<void()> f, const ObjectHandle& sender, const ObjectHandle& receiver);
 
-  void Invoke() const;
+  void Invoke();
 
  private:
-  std::function<void()> f_;
+  UniqueFunction<void()> f_;
 };
 
 }// namespace mdo
@@ -0,0 +1,58 @@
+#include "io_notifier.h"
+
+#include "atomic_helpers.h"
+#include "thread.h"
+
+namespace mdo {
+
+IoNotifier::IoNotifier(mdo::Thread* thread, int fd, IoEvents events)
+    : Object{thread},
+      Ready{this},
+      poller_{GetThreadData(thread)->Poller()},
+      fd_{fd},
+      events_{events},
+      error_{poller_.Add(fd, events, Handle())} {
+  if (error_) {
+    LOG_ERROR("failed to watch the descriptor {}: {}", fd_, error_.message());
+  }
+}
+
+IoNotifier::~IoNotifier() {
+  //
+  // the event loop may be emitting 'Ready' right now, the retirement waits
+  // for it and the following events of the descriptor are skipped
+  //
+  Retire();
+
+  if (error_) {
+    return;
+  }
+
+  if (const auto error = poller_.Remove(fd_)) {
+    LOG_WARNING("failed to stop watching the descriptor {}: {}", fd_, error.message());
+  }
+}
+
+int IoNotifier::Fd() const noexcept { return fd_; }
+
+IoEvents IoNotifier::Events() const noexcept { return LoadAcquire(events_); }
+
+std::error_code IoNotifier::SetEvents(IoEvents events) {
+  if (error_) {
+    return error_;
+  }
+
+  if (const auto error = poller_.Modify(fd_, events, Handle())) {
+    return error;
+  }
+
+  StoreRelease(events_, events);
+
+  return {};
+}
+
+std::error_code IoNotifier::Error() const noexcept { return error_; }
+
+void IoNotifier::Activate(IoEvents events) { Ready(events); }
+
+}// namespace mdo
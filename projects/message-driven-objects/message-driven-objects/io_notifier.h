@@ -0,0 +1,65 @@
+#pragma once
+
+#include "io_poller.h"
+#include "object.h"
+#include "signal_impl.h"
+
+namespace mdo {
+
+//!
+//! Watches a file descriptor in the event loop of a thread.
+//!
+//! The descriptor is registered in the epoll instance of the thread, so the
+//! thread must be started with ThreadOptions::io set. When the descriptor
+//! becomes ready the 'Ready' signal is emitted from the thread the notifier
+//! lives in, in the same loop iteration that handles its messages, so the
+//! connected slots need no locks to access the state of the thread's objects.
+//!
+//! The descriptor is level-triggered: 'Ready' is emitted on every loop
+//! iteration until the descriptor is read (written) or the events are
+//! changed. The notifier doesn't own the descriptor, it must be closed after
+//! the notifier is destroyed.
+//!
+//!   const auto notifier = MakeUnique<IoNotifier>(thread.get(), socket, IoEvents::kRead);
+//!   notifier->Ready.Connect(connection.get(), &Connection::OnReadable);
+//!
+class IoNotifier final : public Object {
+ public:
+  //!
+  //! The ready events of the descriptor, kError is reported even if not
+  //! requested.
+  //!
+  Signal<IoEvents> Ready;
+
+  IoNotifier(mdo::Thread* thread, int fd, IoEvents events);
+  ~IoNotifier() override;
+
+  [[nodiscard]] int Fd() const noexcept;
+
+  [[nodiscard]] IoEvents Events() const noexcept;
+
+  //!
+  //! Changes the watched events, e.g. enables kWrite while there is pending
+  //! output. Returns the error of the epoll instance.
+  //!
+  std::error_code SetEvents(IoEvents events);
+
+  //!
+  //! Returns the error of the registration of the descriptor, the notifier
+  //! never emits 'Ready' if it's set.
+  //!
+  [[nodiscard]] std::error_code Error() const noexcept;
+
+  //!
+  //! Called by the event loop of the thread.
+  //!
+  void Activate(IoEvents events);
+
+ private:
+  details::IoPoller& poller_;
+  int fd_;
+  std::atomic<IoEvents> events_;
+  std::error_code error_;
+};
+
+}// namespace mdo
@@ -0,0 +1,183 @@
+#include "io_poller.h"
+
+namespace mdo {
+
+namespace details {
+
+namespace {
+
+#if defined(__linux__)
+
+constexpr size_t kMaxEventsPerWait = 256;
+
+constexpr uint64_t kWakeupData = std::numeric_limits<uint64_t>::max();
+
+std::error_code LastError() noexcept { return {errno, std::system_category()}; }
+
+uint64_t Pack(const ObjectHandle& handle) noexcept {
+  return uint64_t{handle.generation} << 32 | handle.index;
+}
+
+ObjectHandle Unpack(uint64_t data) noexcept {
+  return {.index = static_cast<uint32_t>(data), .generation = static_cast<uint32_t>(data >> 32)};
+}
+
+uint32_t ToEpoll(IoEvents events) noexcept {
+  uint32_t result = 0;
+
+  if (HasEvents(events, IoEvents::kRead)) {
+    result |= EPOLLIN | EPOLLRDHUP;
+  }
+
+  if (HasEvents(events, IoEvents::kWrite)) {
+    result |= EPOLLOUT;
+  }
+
+  return result;
+}
+
+IoEvents FromEpoll(uint32_t events) noexcept {
+  auto result = IoEvents::kNone;
+
+  if (events & (EPOLLIN | EPOLLPRI)) {
+    result = result | IoEvents::kRead;
+  }
+
+  if (events & EPOLLOUT) {
+    result = result | IoEvents::kWrite;
+  }
+
+  if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+    result = result | IoEvents::kError;
+  }
+
+  return result;
+}
+
+int ToMilliseconds(const std::chrono::nanoseconds& timeout) noexcept {
+  if (timeout == std::chrono::nanoseconds::max()) {
+    return -1;
+  }
+
+  //
+  // rounded up, otherwise a timer due in less than a millisecond would make
+  // the loop spin
+  //
+  const auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+  return static_cast<int>(std::min<int64_t>(ms, std::numeric_limits<int>::max()));
+}
+
+#endif
+
+}// namespace
+
+#if defined(__linux__)
+
+IoPoller::IoPoller()
+    : epoll_fd_{epoll_create1(EPOLL_CLOEXEC)},
+      wakeup_fd_{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)} {
+  if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+    LOG_ERROR("failed to create the epoll instance: {}", LastError().message());
+    return;
+  }
+
+  epoll_event event{.events = EPOLLIN, .data = {.u64 = kWakeupData}};
+
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) != 0) {
+    LOG_ERROR("failed to register the wakeup eventfd: {}", LastError().message());
+  }
+}
+
+IoPoller::~IoPoller() {
+  if (wakeup_fd_ >= 0) {
+    close(wakeup_fd_);
+  }
+
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+  }
+}
+
+std::error_code IoPoller::Add(int fd, IoEvents events, const ObjectHandle& notifier) {
+  epoll_event event{.events = ToEpoll(events), .data = {.u64 = Pack(notifier)}};
+
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+    return LastError();
+  }
+
+  return {};
+}
+
+std::error_code IoPoller::Modify(int fd, IoEvents events, const ObjectHandle& notifier) {
+  epoll_event event{.events = ToEpoll(events), .data = {.u64 = Pack(notifier)}};
+
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) != 0) {
+    return LastError();
+  }
+
+  return {};
+}
+
+std::error_code IoPoller::Remove(int fd) {
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) != 0) {
+    return LastError();
+  }
+
+  return {};
+}
+
+void IoPoller::Wakeup() noexcept {
+  const uint64_t value = 1;
+
+  while (write(wakeup_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {}
+}
+
+std::error_code IoPoller::Wait(const std::chrono::nanoseconds& timeout, std::vector<Event>& events) {
+  std::array<epoll_event, kMaxEventsPerWait> ready;
+
+  const auto count = epoll_wait(epoll_fd_, ready.data(), static_cast<int>(ready.size()), ToMilliseconds(timeout));
+
+  if (count < 0) {
+    return errno == EINTR ? std::error_code{} : LastError();
+  }
+
+  for (int i = 0; i < count; ++i) {
+    if (ready[i].data.u64 == kWakeupData) {
+      uint64_t value;
+      while (read(wakeup_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {}
+      continue;
+    }
+
+    events.push_back({Unpack(ready[i].data.u64), FromEpoll(ready[i].events)});
+  }
+
+  return {};
+}
+
+#else
+
+IoPoller::IoPoller() : epoll_fd_{-1}, wakeup_fd_{-1} {}
+
+IoPoller::~IoPoller() = default;
+
+std::error_code IoPoller::Add(int, IoEvents, const ObjectHandle&) {
+  return std::make_error_code(std::errc::not_supported);
+}
+
+std::error_code IoPoller::Modify(int, IoEvents, const ObjectHandle&) {
+  return std::make_error_code(std::errc::not_supported);
+}
+
+std::error_code IoPoller::Remove(int) { return std::make_error_code(std::errc::not_supported); }
+
+void IoPoller::Wakeup() noexcept {}
+
+std::error_code IoPoller::Wait(const std::chrono::nanoseconds&, std::vector<Event>&) {
+  return std::make_error_code(std::errc::not_supported);
+}
+
+#endif
+
+}// namespace details
+
+}// namespace mdo
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "objects_registry.h"
+
+namespace mdo {
+
+//!
+//! Readiness events of a file descriptor, a bit mask.
+//!
+enum class IoEvents : uint32_t {
+  kNone = 0,
+  kRead = 1 << 0,
+  kWrite = 1 << 1,
+
+  //!
+  //! The error or the hang up, always reported even if not requested.
+  //!
+  kError = 1 << 2
+};
+
+constexpr IoEvents operator|(IoEvents lhs, IoEvents rhs) noexcept {
+  return static_cast<IoEvents>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+}
+
+constexpr IoEvents operator&(IoEvents lhs, IoEvents rhs) noexcept {
+  return static_cast<IoEvents>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+}
+
+constexpr bool HasEvents(IoEvents events, IoEvents mask) noexcept {
+  return (events & mask) != IoEvents::kNone;
+}
+
+namespace details {
+
+//!
+//! The epoll instance of a thread's event loop (see ThreadOptions::io).
+//!
+//! The registered descriptors carry the handle of their IoNotifier, so a
+//! readiness event is delivered to the notifier without any lookup and is
+//! skipped if the notifier is already destroyed. The wakeup of the loop by
+//! a posted message is an eventfd registered in the same instance.
+//!
+//! Only Linux is supported, elsewhere the functions return
+//! std::errc::not_supported.
+//!
+class IoPoller final {
+ public:
+  struct Event {
+    ObjectHandle notifier;
+    IoEvents events;
+  };
+
+  IoPoller();
+  ~IoPoller();
+
+  IoPoller(const IoPoller&) = delete;
+  IoPoller& operator=(const IoPoller&) = delete;
+
+  std::error_code Add(int fd, IoEvents events, const ObjectHandle& notifier);
+  std::error_code Modify(int fd, IoEvents events, const ObjectHandle& notifier);
+  std::error_code Remove(int fd);
+
+  //!
+  //! Interrupts Wait(), thread-safe.
+  //!
+  void Wakeup() noexcept;
+
+  //!
+  //! Waits up to the timeout (rounded up to milliseconds) for the readiness
+  //! of the registered descriptors or for Wakeup(), the ready descriptors
+  //! are appended to the events.
+  //!
+  std::error_code Wait(const std::chrono::nanoseconds& timeout, std::vector<Event>& events);
+
+ private:
+  int epoll_fd_;
+  int wakeup_fd_;
+};
+
+}// namespace details
+
+}// namespace mdo
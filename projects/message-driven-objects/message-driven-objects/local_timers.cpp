@@ -0,0 +1,117 @@
+#include "local_timers.h"
+
+#include "timer_message.h"
+#include "timer_service.h"
+
+namespace mdo {
+
+int LocalTimers::Add(Object* object, const std::chrono::nanoseconds& interval, bool single_shot) {
+  const auto id = TimerService::NextTimerId();
+  const auto deadline = Clock::now() + interval;
+
+  std::scoped_lock _{mutex_};
+  timers_.emplace(id, Timer{object, std::max(interval, std::chrono::nanoseconds{1}), deadline, single_shot});
+  deadlines_.push(Deadline{deadline, id});
+
+  return id;
+}
+
+bool LocalTimers::Remove(int id) {
+  std::scoped_lock _{mutex_};
+
+  if (!timers_.erase(id)) {
+    return false;
+  }
+
+  //
+  // the heap entries of killed timers are removed lazily, the heap is
+  // rebuilt if they make up the most of it
+  //
+  if (deadlines_.size() > 2 * timers_.size() + 64) {
+    Compact();
+  }
+
+  return true;
+}
+
+bool LocalTimers::Reset(int id) {
+  std::scoped_lock _{mutex_};
+  const auto it = timers_.find(id);
+
+  if (it == timers_.end()) {
+    return false;
+  }
+
+  //
+  // the deadline only moves forward, so the heap entry is fixed up when it
+  // reaches the top
+  //
+  it->second.deadline = Clock::now() + it->second.interval;
+
+  return true;
+}
+
+std::chrono::nanoseconds LocalTimers::Timeout(const std::chrono::nanoseconds& max_timeout) const {
+  std::scoped_lock _{mutex_};
+
+  if (deadlines_.empty()) {
+    return max_timeout;
+  }
+
+  const auto timeout = deadlines_.top().deadline - Clock::now();
+
+  return std::clamp<std::chrono::nanoseconds>(timeout, std::chrono::nanoseconds::zero(), max_timeout);
+}
+
+void LocalTimers::Expire(std::vector<Message>& messages) {
+  const auto now = Clock::now();
+
+  std::scoped_lock _{mutex_};
+
+  while (!deadlines_.empty() && deadlines_.top().deadline <= now) {
+    const auto [deadline, id] = deadlines_.top();
+    deadlines_.pop();
+
+    const auto it = timers_.find(id);
+
+    if (it == timers_.end()) {
+      continue;
+    }
+
+    auto& timer = it->second;
+
+    if (timer.deadline > deadline) {
+      deadlines_.push(Deadline{timer.deadline, id});
+      continue;
+    }
+
+    messages.emplace_back(TimerMessage{id, nullptr, timer.object});
+
+    if (timer.single_shot) {
+      timers_.erase(it);
+      continue;
+    }
+
+    const auto missed = (now - timer.deadline) / timer.interval;
+    timer.deadline += (missed + 1) * timer.interval;
+    deadlines_.push(Deadline{timer.deadline, id});
+  }
+}
+
+size_t LocalTimers::Size() const noexcept {
+  std::scoped_lock _{mutex_};
+  return timers_.size();
+}
+
+void LocalTimers::Compact() {
+  std::vector<Deadline> deadlines;
+  deadlines.reserve(timers_.size());
+
+  for (const auto& [id, timer] : timers_) {
+    deadlines.push_back(Deadline{timer.deadline, id});
+  }
+
+  deadlines_ = decltype(deadlines_){std::greater<>{}, std::move(deadlines)};
+}
+
+}// namespace mdo
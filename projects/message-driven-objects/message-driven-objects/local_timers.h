@@ -0,0 +1,81 @@
+#pragma once
+
+#include "message.h"
+
+namespace mdo {
+
+class Object;
+
+//!
+//! Timers of the objects living in one thread, evaluated by the thread's
+//! own event loop (see Thread::Run): the loop uses the nearest deadline as
+//! the poll timeout and handles the expired ticks together with the polled
+//! messages, so a tick doesn't cross threads and doesn't touch the queue.
+//!
+//! Timers are stored in a binary heap of deadlines. Killing a timer only
+//! forgets it and resetting it only moves its deadline forward, the heap
+//! entries of such timers are fixed up lazily when they reach the top.
+//!
+//! Note: All functions are thread-safe, but only the owner thread adds the
+//! timers and evaluates them.
+//!
+class LocalTimers final {
+ public:
+  LocalTimers() = default;
+
+  LocalTimers(const LocalTimers& other) = delete;
+  LocalTimers& operator=(const LocalTimers& other) = delete;
+
+  int Add(Object* object, const std::chrono::nanoseconds& interval, bool single_shot = false);
+
+  //!
+  //! Returns false if there is no timer with such id.
+  //!
+  bool Remove(int id);
+
+  //!
+  //! Restarts the countdown of the timer.
+  //! Returns false if there is no timer with such id.
+  //!
+  bool Reset(int id);
+
+  //!
+  //! Returns the time left to the nearest deadline but not more than
+  //! max_timeout.
+  //!
+  std::chrono::nanoseconds Timeout(const std::chrono::nanoseconds& max_timeout) const;
+
+  //!
+  //! Appends TimerMessage for each expired timer to the messages.
+  //! A periodic timer which missed several periods ticks only once.
+  //!
+  void Expire(std::vector<Message>& messages);
+
+  size_t Size() const noexcept;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Timer {
+    Object* object;
+    std::chrono::nanoseconds interval;
+    Clock::time_point deadline;
+    bool single_shot;
+  };
+
+  struct Deadline {
+    Clock::time_point deadline;
+    int id;
+
+    bool operator>(const Deadline& other) const noexcept { return deadline > other.deadline; }
+  };
+
+  void Compact();
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<int, Timer> timers_;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> deadlines_;
+};
+
+}// namespace mdo
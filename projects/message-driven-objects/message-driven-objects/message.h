@@ -1,5 +1,6 @@
 #pragma once
 
+#include "any_message.h"
 #include "benchmark_message.h"
 #include "invoke_slot_message.h"
 #include "set_thread_name_message.h"
@@ -11,7 +12,7 @@ namespace mdo {
 class Thread;
 
 using Message =
-  std::variant<std::monostate, InvokeSlotMessage, TestMessage, BenchmarkMessage, SetThreadNameMessage, TimerMessage>;
+  std::variant<std::monostate, InvokeSlotMessage, TestMessage, BenchmarkMessage, SetThreadNameMessage, TimerMessage, AnyMessage>;
 
 const auto GetReceiver = [](auto&& msg) -> Object* {
   using T = std::decay_t<decltype(msg)>;
@@ -23,6 +24,38 @@ const auto GetReceiver = [](auto&& msg) -> Object* {
   }
 };
 
+const auto GetReceiverHandle = [](auto&& msg) -> ObjectHandle {
+  using T = std::decay_t<decltype(msg)>;
+
+  if constexpr (std::is_same_v<std::monostate, T>) {
+    abort();
+  } else {
+    return msg.ReceiverHandle();
+  }
+};
+
+const auto GetPostedAt = [](auto&& msg) -> std::chrono::steady_clock::time_point {
+  using T = std::decay_t<decltype(msg)>;
+
+  if constexpr (std::is_same_v<std::monostate, T>) {
+    return {};
+  } else {
+    return msg.PostedAt();
+  }
+};
+
+inline void SetPostedAt(Message& message, const std::chrono::steady_clock::time_point& time) {
+  std::visit(
+    [&time](auto& msg) {
+      using T = std::decay_t<decltype(msg)>;
+
+      if constexpr (!std::is_same_v<std::monostate, T>) {
+        msg.SetPostedAt(time);
+      }
+    },
+    message);
+}
+
 const auto GetSender = [](auto&& msg) -> Object* {
   using T = std::decay_t<decltype(msg)>;
 
@@ -5,11 +5,25 @@
 namespace mdo {
 
 MessageBase::MessageBase(Object* sender, Object* receiver)
+    : sender_{sender ? sender->Handle() : ObjectHandle{}},
+      receiver_{receiver ? receiver->Handle() : ObjectHandle{}} {}
+
+MessageBase::MessageBase(const ObjectHandle& sender, const ObjectHandle& receiver)
     : sender_{sender},
       receiver_{receiver} {}
 
-Object* MessageBase::Sender() const noexcept { return sender_; }
+Object* MessageBase::Sender() const noexcept { return sender_.Get(); }
+
+Object* MessageBase::Receiver() const noexcept { return receiver_.Get(); }
+
+const ObjectHandle& MessageBase::SenderHandle() const noexcept { return sender_; }
+
+const ObjectHandle& MessageBase::ReceiverHandle() const noexcept { return receiver_; }
+
+std::chrono::steady_clock::time_point MessageBase::PostedAt() const noexcept { return posted_at_; }
 
-Object* MessageBase::Receiver() const noexcept { return receiver_; }
+void MessageBase::SetPostedAt(const std::chrono::steady_clock::time_point& time) noexcept {
+  posted_at_ = time;
+}
 
 }// namespace mdo
\ No newline at end of file
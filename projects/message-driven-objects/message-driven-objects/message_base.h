@@ -1,5 +1,7 @@
 #pragma once
 
+#include "objects_registry.h"
+
 namespace mdo {
 
 class Object;
@@ -8,12 +10,33 @@ class MessageBase {
  public:
   MessageBase(Object* sender, Object* receiver);
 
+  MessageBase(const ObjectHandle& sender, const ObjectHandle& receiver);
+
+  //!
+  //! Return the sender and the receiver or nullptr if they are already dead.
+  //!
   [[nodiscard]] Object* Sender() const noexcept;
   [[nodiscard]] Object* Receiver() const noexcept;
 
+  //!
+  //! The message holds handles of its sender and receiver instead of raw
+  //! pointers, so it can outlive them. The receiver handle is pinned while
+  //! the message is delivered.
+  //!
+  [[nodiscard]] const ObjectHandle& SenderHandle() const noexcept;
+  [[nodiscard]] const ObjectHandle& ReceiverHandle() const noexcept;
+
+  //!
+  //! The time the message was posted to a queue. Set only when the metrics
+  //! timings are enabled, see Metrics::SetTimingsEnabled().
+  //!
+  [[nodiscard]] std::chrono::steady_clock::time_point PostedAt() const noexcept;
+  void SetPostedAt(const std::chrono::steady_clock::time_point& time) noexcept;
+
  private:
-  Object* sender_;
-  Object* receiver_;
+  ObjectHandle sender_;
+  ObjectHandle receiver_;
+  std::chrono::steady_clock::time_point posted_at_;
 };
 
 }// namespace mdo
\ No newline at end of file
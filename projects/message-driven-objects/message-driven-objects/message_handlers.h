@@ -0,0 +1,67 @@
+#pragma once
+
+#include "any_message.h"
+
+namespace mdo {
+
+//!
+//! Dispatch table mapping AnyMessage payload types to the handlers of the
+//! Derived class. The table is built at compile time from the list of the
+//! payload types, the Derived class must have a Handle(T&) method for each
+//! of them:
+//!
+//!   class Session : public Object {
+//!    protected:
+//!     void OnAnyMessage(AnyMessage& message) override {
+//!       MessageHandlers<Session, PriceUpdate, OrderAck>::Dispatch(this, message);
+//!     }
+//!
+//!    private:
+//!     friend MessageHandlers<Session, PriceUpdate, OrderAck>;
+//!
+//!     void Handle(PriceUpdate& update);
+//!     void Handle(OrderAck& ack);
+//!   };
+//!
+//! The lookup is a linear scan comparing type identifiers, that is as cheap
+//! as std::visit jump for the small number of types an object usually
+//! handles.
+//!
+template <typename Derived, typename... MessageTypes>
+class MessageHandlers final {
+ public:
+  //!
+  //! Calls the handler of the message payload.
+  //! Returns false if the Derived class doesn't handle messages of this type.
+  //!
+  static bool Dispatch(Derived* object, AnyMessage& message) {
+    const auto type = message.TypeId();
+
+    for (const auto& entry : kTable) {
+      if (entry.type == type) {
+        entry.handler(object, message);
+        return true;
+      }
+    }
+
+    LOG_WARNING("message of type '{}' is not handled by the receiver", message.TypeName());
+
+    return false;
+  }
+
+ private:
+  struct Entry {
+    MessageTypeId type;
+    void (*handler)(Derived* object, AnyMessage& message);
+  };
+
+  template <typename T>
+  static void Invoke(Derived* object, AnyMessage& message) {
+    object->Handle(message.Payload<T>());
+  }
+
+  static constexpr std::array<Entry, sizeof...(MessageTypes)> kTable{
+    Entry{AnyMessage::TypeIdOf<MessageTypes>(), &Invoke<MessageTypes>}...};
+};
+
+}// namespace mdo
@@ -0,0 +1,20 @@
+#include "message_priority.h"
+
+#include "overloaded.h"
+
+namespace mdo {
+
+MessagePriority DefaultPriority(const Message& message) noexcept {
+  return std::visit(
+    Overloaded{
+      [](const SetThreadNameMessage&) { return MessagePriority::kControl; },
+      [](const TimerMessage&) { return MessagePriority::kTimer; },
+      [](const InvokeSlotMessage&) { return MessagePriority::kNormal; },
+      [](const TestMessage&) { return MessagePriority::kBulk; },
+      [](const BenchmarkMessage&) { return MessagePriority::kBulk; },
+      [](const AnyMessage&) { return MessagePriority::kNormal; },
+      [](const std::monostate&) { return MessagePriority::kNormal; }},
+    message);
+}
+
+}// namespace mdo
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "message.h"
+
+namespace mdo {
+
+//!
+//! Lanes of a MessageQueue. A consumer drains the lanes in the declaration
+//! order, i.e. messages of the higher priority overtake the messages of the
+//! lower priority which were posted earlier. Messages of the same lane keep
+//! their order.
+//!
+enum class MessagePriority : uint8_t {
+  kControl,
+  kTimer,
+  kNormal,
+  kBulk
+};
+
+constexpr size_t kMessagePrioritiesCount = 4;
+
+//!
+//! Returns the priority used to post the message if the sender didn't
+//! specify it explicitly.
+//!
+MessagePriority DefaultPriority(const Message& message) noexcept;
+
+}// namespace mdo
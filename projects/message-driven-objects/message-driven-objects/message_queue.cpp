@@ -1,39 +1,198 @@
 #include "message_queue.h"
 
+#include "atomic_helpers.h"
+#include "metrics.h"
+#include "wait_primitives.h"
+
 namespace mdo {
 
-MessageQueue::MessageQueue() : interrupt_{} {}
+namespace {
 
-void MessageQueue::Post(Message&& message) {
-  std::unique_lock _{mutex_};
-  messages_.push_back(std::move(message));
-  condition_.notify_all();
+thread_local size_t non_blocking_post_depth = 0;
+
+std::optional<uint64_t> DefaultCoalescingKey(const Message& message) {
+  //
+  // the messages of these types carry different slots or payloads to the
+  // same receiver, they are coalesced only by an explicit key
+  //
+  if (std::holds_alternative<InvokeSlotMessage>(message) || std::holds_alternative<AnyMessage>(message)) {
+    return std::nullopt;
+  }
+
+  const auto receiver = std::visit(GetReceiverHandle, message);
+
+  //
+  // the index of a handle fits into 24 bits, the lowest byte is free for the
+  // message type
+  //
+  static_assert(ObjectsRegistry::kMaxObjects <= (size_t{1} << 24));
+
+  return (uint64_t{receiver.index} << 40) | (uint64_t{receiver.generation} << 8) | message.index();
+}
+
+//
+// the counters have the only writer, so the increment doesn't need the
+// locked read-modify-write instruction
+//
+void Increment(std::atomic_uint64_t& counter) noexcept {
+  StoreRelaxed(counter, LoadRelaxed(counter) + 1);
+}
+
+}// namespace
+
+NonBlockingPostScope::NonBlockingPostScope() noexcept { ++non_blocking_post_depth; }
+
+NonBlockingPostScope::~NonBlockingPostScope() { --non_blocking_post_depth; }
+
+bool NonBlockingPostScope::Active() noexcept { return non_blocking_post_depth != 0; }
+
+MessageQueue::MessageQueue()
+    : erased_{},
+      starvation_{},
+      size_{},
+      dropped_{},
+      posted_{},
+      max_size_{},
+      above_high_watermark_{},
+      interrupt_{},
+      closed_{},
+      external_wait_{},
+      parked_{},
+      wakeups_{},
+      spun_{},
+      yielded_{},
+      parked_count_{},
+      timed_out_{} {}
+
+std::error_code MessageQueue::Post(Message&& message) {
+  const auto priority = DefaultPriority(message);
+  return Post(std::move(message), priority);
+}
+
+std::error_code MessageQueue::Post(Message&& message, MessagePriority priority) {
+  WatermarkHandler on_high_watermark;
+  size_t size = 0;
+  std::error_code error;
+
+  if (Metrics::TimingsEnabled()) {
+    SetPostedAt(message, std::chrono::steady_clock::now());
+  }
+
+  {
+    std::unique_lock lock{mutex_};
+
+    error = Enqueue(lock, std::move(message), static_cast<size_t>(priority), on_high_watermark);
+    size = size_;
+  }
+
+  if (on_high_watermark) {
+    on_high_watermark(size);
+  }
+
+  return error;
+}
+
+std::error_code MessageQueue::Post(std::vector<Message>& messages, MessagePriority priority) {
+  WatermarkHandler on_high_watermark;
+  size_t size = 0;
+  std::error_code error;
+
+  if (Metrics::TimingsEnabled()) {
+    const auto now = std::chrono::steady_clock::now();
 
-  LOG_TRACE("pushed message to queue '{}', queue size '{}'", (void*) this, messages_.size());
+    for (auto& message : messages) {
+      SetPostedAt(message, now);
+    }
+  }
+
+  {
+    std::unique_lock lock{mutex_};
+
+    for (auto& message : messages) {
+      if (const auto message_error = Enqueue(lock, std::move(message), static_cast<size_t>(priority), on_high_watermark)) {
+        error = message_error;
+      }
+    }
+
+    size = size_;
+  }
+
+  messages.clear();
+
+  if (on_high_watermark) {
+    on_high_watermark(size);
+  }
+
+  return error;
 }
 
 std::error_code
 MessageQueue::Poll(std::vector<Message>& messages,
-                   const std::chrono::seconds& timeout) noexcept {
-  std::unique_lock _{mutex_};
-
-  const auto has_event_or_interrupted = [this] {
-    return interrupt_ || !messages_.empty();
-  };
+                   const std::chrono::nanoseconds& timeout) noexcept {
+  WatermarkHandler on_low_watermark;
+  size_t size = 0;
 
-  if (!condition_.wait_for(_, timeout, has_event_or_interrupted)) {
+  //
+  // a busy polling consumer doesn't contend with the producers for the
+  // mutex while the queue is empty
+  //
+  if (timeout == 0ns && !size_.load(std::memory_order_acquire) && !interrupt_.load(std::memory_order_acquire)) {
     return std::make_error_code(std::errc::timed_out);
   }
 
-  if (interrupt_) {
-    return std::make_error_code(std::errc::interrupted);
+  //
+  // the adaptive wait doesn't take the lock until there is something to
+  // extract
+  //
+  auto wait_timeout = timeout;
+
+  if (timeout != 0ns && wait_options_.strategy == WaitStrategy::kAdaptive) {
+    if (!WaitAdaptive(timeout)) {
+      return std::make_error_code(std::errc::timed_out);
+    }
+
+    wait_timeout = 0ns;
   }
 
-  swap(messages, messages_);
-  _.unlock();
+  {
+    std::unique_lock lock{mutex_};
+
+    consumer_ = std::this_thread::get_id();
 
+    const auto has_event_or_interrupted = [this] {
+      return interrupt_ || size_;
+    };
+
+    if (wait_timeout == kInfiniteTimeout) {
+      condition_.wait(lock, has_event_or_interrupted);
+    } else if (!condition_.wait_for(lock, wait_timeout, has_event_or_interrupted)) {
+      return std::make_error_code(std::errc::timed_out);
+    }
+
+    if (interrupt_) {
+      return std::make_error_code(std::errc::interrupted);
+    }
+
+    messages.clear();
+    ExtractBatch(messages);
+
+    if (above_high_watermark_ && size_ <= limits_.low_watermark) {
+      above_high_watermark_ = false;
+      on_low_watermark = on_low_watermark_;
+    }
+
+    size = size_;
+  }
+
+  //
+  // wakes up producers blocked on the full queue
+  //
   condition_.notify_all();
 
+  if (on_low_watermark) {
+    on_low_watermark(size);
+  }
+
   return {};
 }
 
@@ -43,18 +202,478 @@ void MessageQueue::SetInterruptFlag(bool value) noexcept {
   std::lock_guard _{mutex_};
   interrupt_ = value;
   condition_.notify_all();
+  WakeExternalWaiter();
+  WakeParkedConsumer();
+}
+
+void MessageQueue::SetClosed(bool value) noexcept {
+  LOG_TRACE("set closed flag for queue '{}' to '{}'", (void*) this, value);
+
+  std::lock_guard _{mutex_};
+  closed_ = value;
+  condition_.notify_all();
+  WakeExternalWaiter();
+}
+
+bool MessageQueue::IsClosed() const noexcept {
+  std::lock_guard _{mutex_};
+  return closed_;
+}
+
+void MessageQueue::SetWakeupHandler(WakeupHandler handler) {
+  std::lock_guard _{mutex_};
+  wakeup_handler_ = std::move(handler);
+}
+
+bool MessageQueue::PrepareExternalWait() noexcept {
+  std::lock_guard _{mutex_};
+
+  consumer_ = std::this_thread::get_id();
+
+  if (interrupt_ || size_) {
+    return false;
+  }
+
+  external_wait_ = true;
+  return true;
+}
+
+void MessageQueue::FinishExternalWait() noexcept {
+  std::lock_guard _{mutex_};
+  external_wait_ = false;
+}
+
+void MessageQueue::SetWaitOptions(const WaitOptions& options) noexcept {
+  wait_options_ = options;
+}
+
+WaitStats MessageQueue::AdaptiveWaitStats() const noexcept {
+  return {
+    .spun = LoadRelaxed(spun_),
+    .yielded = LoadRelaxed(yielded_),
+    .parked = LoadRelaxed(parked_count_),
+    .timed_out = LoadRelaxed(timed_out_),
+  };
+}
+
+void MessageQueue::SetLimits(const QueueLimits& limits) {
+  std::lock_guard _{mutex_};
+  limits_ = limits;
+
+  if (limits_.policy == OverflowPolicy::kCoalesce && !limits_.coalescing_key) {
+    limits_.coalescing_key = DefaultCoalescingKey;
+  }
+
+  if (limits_.policy != OverflowPolicy::kCoalesce) {
+    coalescing_.clear();
+  }
+
+  condition_.notify_all();
+}
+
+void MessageQueue::SetWatermarkHandlers(WatermarkHandler on_high, WatermarkHandler on_low) {
+  std::lock_guard _{mutex_};
+  on_high_watermark_ = std::move(on_high);
+  on_low_watermark_ = std::move(on_low);
 }
 
 void MessageQueue::Clear() noexcept {
   LOG_TRACE("clearing queue '{}'", (void*) this);
 
-  std::lock_guard _{mutex_};
-  messages_.clear();
+  WatermarkHandler on_low_watermark;
+
+  {
+    std::lock_guard _{mutex_};
+
+    for (auto& lane : lanes_) {
+      lane.clear();
+    }
+
+    erased_.fill(0);
+    coalescing_.clear();
+    starvation_.fill(0);
+    size_ = 0;
+
+    if (above_high_watermark_) {
+      above_high_watermark_ = false;
+      on_low_watermark = on_low_watermark_;
+    }
+
+    condition_.notify_all();
+  }
+
+  if (on_low_watermark) {
+    on_low_watermark(0);
+  }
 }
 
 size_t MessageQueue::Size() const noexcept {
   std::lock_guard _{mutex_};
-  return messages_.size();
+  return size_;
+}
+
+size_t MessageQueue::Size(MessagePriority priority) const noexcept {
+  std::lock_guard _{mutex_};
+  return LaneSize(static_cast<size_t>(priority));
+}
+
+size_t MessageQueue::DroppedCount() const noexcept {
+  std::lock_guard _{mutex_};
+  return dropped_;
+}
+
+size_t MessageQueue::PostedCount() const noexcept {
+  std::lock_guard _{mutex_};
+  return posted_;
+}
+
+size_t MessageQueue::MaxSize() const noexcept {
+  std::lock_guard _{mutex_};
+  return max_size_;
+}
+
+std::error_code MessageQueue::Enqueue(std::unique_lock<std::recursive_mutex>& lock,
+                                      Message&& message,
+                                      size_t lane,
+                                      WatermarkHandler& on_high_watermark) {
+  std::optional<uint64_t> key;
+
+  if (closed_) {
+    LOG_TRACE("queue '{}' is closed, message is rejected", (void*) this);
+    return std::make_error_code(std::errc::broken_pipe);
+  }
+
+  if (limits_.policy == OverflowPolicy::kCoalesce && Coalesce(message, lane, key)) {
+    LOG_TRACE("coalesced message in queue '{}', queue size '{}'", (void*) this, size_.load());
+    return {};
+  }
+
+  if (Full()) {
+    if (const auto error = MakeRoom(lock, lane)) {
+      LOG_TRACE("queue '{}' is full, message is rejected: {}", (void*) this, error.message());
+      return error;
+    }
+  }
+
+  auto& entry = lanes_[lane].emplace_back(Entry{std::move(message), key, lane, false});
+  ++size_;
+  ++posted_;
+  max_size_ = std::max<size_t>(max_size_, size_);
+
+  if (key.has_value()) {
+    coalescing_[*key] = &entry;
+  }
+
+  if (limits_.high_watermark && !above_high_watermark_ && size_ >= limits_.high_watermark) {
+    above_high_watermark_ = true;
+    on_high_watermark = on_high_watermark_;
+  }
+
+  condition_.notify_all();
+  WakeExternalWaiter();
+  WakeParkedConsumer();
+
+  LOG_TRACE("pushed message to queue '{}', lane '{}' size '{}'", (void*) this, lane, LaneSize(lane));
+
+  return {};
+}
+
+//
+// a sleeping consumer is woken up once, the following posts see the flag
+// cleared and don't repeat the system call
+//
+void MessageQueue::WakeExternalWaiter() {
+  if (external_wait_ && wakeup_handler_) {
+    external_wait_ = false;
+    wakeup_handler_();
+  }
+}
+
+//
+// the seq_cst increment of the size (or the store of the interruption) and
+// the load of the flag here pair with the store of the flag and the load of
+// the size by the parking consumer, so at least one of them sees the other
+//
+void MessageQueue::WakeParkedConsumer() noexcept {
+  if (LoadSeqCst(parked_) && parked_.exchange(false)) {
+    wakeups_.fetch_add(1);
+    details::WakeAll(wakeups_);
+  }
+}
+
+bool MessageQueue::HasEventOrInterrupted() const noexcept {
+  return LoadSeqCst(size_) || LoadSeqCst(interrupt_);
+}
+
+bool MessageQueue::WaitAdaptive(const std::chrono::nanoseconds& timeout) noexcept {
+  using Clock = std::chrono::steady_clock;
+
+  //
+  // reading the clock costs more than checking the queue, so it's read once
+  // per a batch of checks
+  //
+  constexpr size_t kSpinBatch = 64;
+
+  const auto start = Clock::now();
+  const auto deadline = timeout < Clock::time_point::max() - start ? start + timeout : Clock::time_point::max();
+
+  const auto until = [start, deadline](const std::chrono::nanoseconds& budget) {
+    return budget < deadline - start ? start + budget : deadline;
+  };
+
+  const auto spin_until = until(wait_options_.spin_budget);
+
+  for (auto now = start; now < spin_until; now = Clock::now()) {
+    for (size_t i = 0; i < kSpinBatch; ++i) {
+      if (HasEventOrInterrupted()) {
+        Increment(spun_);
+        return true;
+      }
+
+      details::CpuRelax();
+    }
+  }
+
+  const auto yield_until = until(wait_options_.spin_budget + wait_options_.yield_budget);
+
+  for (auto now = Clock::now(); now < yield_until; now = Clock::now()) {
+    if (HasEventOrInterrupted()) {
+      Increment(yielded_);
+      return true;
+    }
+
+    std::this_thread::yield();
+  }
+
+#if defined(__linux__)
+  while (true) {
+    StoreSeqCst(parked_, true);
+
+    const auto wakeups = LoadSeqCst(wakeups_);
+
+    if (HasEventOrInterrupted()) {
+      StoreRelaxed(parked_, false);
+      Increment(yielded_);
+      return true;
+    }
+
+    const auto now = Clock::now();
+
+    if (now >= deadline) {
+      StoreRelaxed(parked_, false);
+      Increment(timed_out_);
+      return false;
+    }
+
+    if (deadline == Clock::time_point::max()) {
+      details::WaitWhileEqual(wakeups_, wakeups);
+    } else {
+      details::WaitWhileEqualFor(wakeups_, wakeups, deadline - now);
+    }
+
+    StoreRelaxed(parked_, false);
+
+    if (HasEventOrInterrupted()) {
+      Increment(parked_count_);
+      return true;
+    }
+  }
+#else
+  std::unique_lock lock{mutex_};
+
+  const auto has_event_or_interrupted = [this] {
+    return interrupt_ || size_;
+  };
+
+  auto found = true;
+
+  if (deadline == Clock::time_point::max()) {
+    condition_.wait(lock, has_event_or_interrupted);
+  } else {
+    found = condition_.wait_until(lock, deadline, has_event_or_interrupted);
+  }
+
+  Increment(found ? parked_count_ : timed_out_);
+
+  return found;
+#endif
+}
+
+bool MessageQueue::Full() const noexcept {
+  return limits_.capacity && size_ >= limits_.capacity;
+}
+
+std::error_code MessageQueue::MakeRoom(std::unique_lock<std::recursive_mutex>& lock, size_t lane) {
+  switch (limits_.policy) {
+    case OverflowPolicy::kBlock: {
+      //
+      // the consumer would wait for itself
+      //
+      if (consumer_ == std::this_thread::get_id()) {
+        return {};
+      }
+
+      //
+      // the producer holds a lock the consumer may need
+      //
+      if (NonBlockingPostScope::Active()) {
+        return std::make_error_code(std::errc::resource_unavailable_try_again);
+      }
+
+      condition_.wait(lock, [this] { return interrupt_ || closed_ || !Full(); });
+
+      if (interrupt_) {
+        return std::make_error_code(std::errc::interrupted);
+      }
+
+      if (closed_) {
+        return std::make_error_code(std::errc::broken_pipe);
+      }
+
+      return {};
+    }
+
+    case OverflowPolicy::kDropOldest: {
+      for (size_t victim = lanes_.size(); victim-- > lane;) {
+        if (!lanes_[victim].empty()) {
+          PopFront(victim);
+          ++dropped_;
+          return {};
+        }
+      }
+
+      return std::make_error_code(std::errc::no_buffer_space);
+    }
+
+    case OverflowPolicy::kFailFast:
+    case OverflowPolicy::kCoalesce:
+      return std::make_error_code(std::errc::no_buffer_space);
+  }
+
+  return {};
+}
+
+bool MessageQueue::Coalesce(Message& message, size_t lane, std::optional<uint64_t>& key) {
+  key = limits_.coalescing_key(message);
+
+  if (!key.has_value()) {
+    return false;
+  }
+
+  const auto it = coalescing_.find(*key);
+
+  if (it == coalescing_.end()) {
+    return false;
+  }
+
+  auto& pending = *it->second;
+  ++dropped_;
+
+  if (pending.lane == lane) {
+    pending.message = std::move(message);
+    return true;
+  }
+
+  //
+  // the posted message is of another priority, so it goes to the end of its
+  // own lane and the pending one is dropped
+  //
+  Erase(pending);
+
+  return false;
+}
+
+//
+// erasing from the middle of a deque would move the rest of its entries, so
+// the entry is only marked as erased and is skipped when it reaches the front
+// of the lane
+//
+void MessageQueue::Erase(Entry& entry) {
+  coalescing_.erase(*entry.key);
+
+  entry.message = {};
+  entry.key.reset();
+  entry.erased = true;
+
+  ++erased_[entry.lane];
+  --size_;
+
+  DropErased(entry.lane);
+}
+
+void MessageQueue::DropErased(size_t lane) {
+  auto& entries = lanes_[lane];
+
+  while (!entries.empty() && entries.front().erased) {
+    entries.pop_front();
+    --erased_[lane];
+  }
+}
+
+size_t MessageQueue::LaneSize(size_t lane) const noexcept {
+  return lanes_[lane].size() - erased_[lane];
+}
+
+void MessageQueue::PopFront(size_t lane) {
+  auto& entry = lanes_[lane].front();
+
+  if (entry.key.has_value()) {
+    const auto it = coalescing_.find(*entry.key);
+
+    if (it != coalescing_.end() && it->second == &entry) {
+      coalescing_.erase(it);
+    }
+  }
+
+  lanes_[lane].pop_front();
+  --size_;
+
+  DropErased(lane);
+}
+
+void MessageQueue::ExtractBatch(std::vector<Message>& messages) {
+  constexpr auto kControl = static_cast<size_t>(MessagePriority::kControl);
+
+  Extract(kControl, LaneSize(kControl), messages);
+
+  std::array<size_t, kMessagePrioritiesCount> extracted{};
+  size_t budget = kBatchSize;
+
+  //
+  // starving lanes are served first, but only with their quota
+  //
+  for (size_t lane = kControl + 1; lane < lanes_.size() && budget; ++lane) {
+    if (starvation_[lane] >= kStarvationLimit) {
+      const auto count = Extract(lane, std::min(budget, kStarvationQuota), messages);
+      extracted[lane] += count;
+      budget -= count;
+    }
+  }
+
+  for (size_t lane = kControl + 1; lane < lanes_.size() && budget; ++lane) {
+    const auto count = Extract(lane, budget, messages);
+    extracted[lane] += count;
+    budget -= count;
+  }
+
+  for (size_t lane = kControl + 1; lane < lanes_.size(); ++lane) {
+    if (extracted[lane] || lanes_[lane].empty()) {
+      starvation_[lane] = 0;
+    } else {
+      ++starvation_[lane];
+    }
+  }
+}
+
+size_t MessageQueue::Extract(size_t lane, size_t count, std::vector<Message>& messages) {
+  count = std::min(count, LaneSize(lane));
+
+  for (size_t i = 0; i < count; ++i) {
+    messages.push_back(std::move(lanes_[lane].front().message));
+    PopFront(lane);
+  }
+
+  return count;
 }
 
-}// namespace mdo
\ No newline at end of file
+}// namespace mdo
@@ -1,36 +1,276 @@
 #pragma once
 
 #include "message.h"
+#include "message_priority.h"
+#include "wait_strategy.h"
 
 namespace mdo {
 
+//!
+//! Defines what MessageQueue::Post does when the queue is full.
+//!
+enum class OverflowPolicy : uint8_t {
+  //!
+  //! The producer is blocked until the consumer extracts messages.
+  //! The consumer thread posting to its own queue is never blocked, its
+  //! messages are enqueued over the capacity.
+  //!
+  //! The producer must not hold a lock the consumer needs to make progress,
+  //! otherwise both wait forever. A producer which posts under such a lock
+  //! opens NonBlockingPostScope, then the full queue rejects the message
+  //! with std::errc::resource_unavailable_try_again instead of blocking.
+  //!
+  kBlock,
+
+  //!
+  //! The message is rejected with std::errc::no_buffer_space.
+  //!
+  kFailFast,
+
+  //!
+  //! The oldest message of the lowest priority lane which is not more
+  //! important than the posted message is dropped. If there is no such lane
+  //! the posted message is rejected with std::errc::no_buffer_space.
+  //!
+  kDropOldest,
+
+  //!
+  //! A pending message with the same coalescing key is replaced by the posted
+  //! one (at the position of the pending message, or at the end of the lane
+  //! of the posted message if their priorities differ). Messages are
+  //! coalesced regardless of the queue size. If there is no message to replace and the
+  //! queue is full, the message is rejected with std::errc::no_buffer_space.
+  //!
+  kCoalesce
+};
+
+struct QueueLimits {
+  using CoalescingKey = std::function<std::optional<uint64_t>(const Message&)>;
+
+  //!
+  //! Max number of pending messages, 0 means the queue is unbounded.
+  //!
+  size_t capacity = 0;
+
+  OverflowPolicy policy = OverflowPolicy::kFailFast;
+
+  //!
+  //! The high watermark handler is called when the queue size reaches this
+  //! value, 0 disables the watermarks.
+  //!
+  size_t high_watermark = 0;
+
+  //!
+  //! The low watermark handler is called when the queue size drops to this
+  //! value after reaching the high watermark.
+  //!
+  size_t low_watermark = 0;
+
+  //!
+  //! Returns the key used by kCoalesce policy, messages without a key are
+  //! never coalesced. If not set messages are coalesced by the receiver and
+  //! the message type, except InvokeSlotMessage and AnyMessage which are
+  //! never coalesced by default: a receiver has many slots and payloads.
+  //!
+  CoalescingKey coalescing_key;
+};
+
+//!
+//! Makes the kBlock queues reject the messages posted by the current thread
+//! with std::errc::resource_unavailable_try_again instead of blocking the
+//! thread while the scope is alive. The scopes can be nested.
+//!
+//!   std::scoped_lock _{registry_mutex};
+//!   NonBlockingPostScope non_blocking;
+//!   Dispatcher::Dispatch(...);
+//!
+class NonBlockingPostScope final {
+ public:
+  NonBlockingPostScope() noexcept;
+  ~NonBlockingPostScope();
+
+  NonBlockingPostScope(const NonBlockingPostScope&) = delete;
+  NonBlockingPostScope& operator=(const NonBlockingPostScope&) = delete;
+
+  static bool Active() noexcept;
+};
+
 class MessageQueue {
  public:
+  using WatermarkHandler = std::function<void(size_t)>;
+  using WakeupHandler = std::function<void()>;
+
   MessageQueue();
 
-  void Post(Message&& message);
+  //!
+  //! Posts a message to the lane corresponding to DefaultPriority(message).
+  //!
+  std::error_code Post(Message&& message);
+
+  //!
+  //! Posts a message to the lane of the specified priority.
+  //!
+  //! Returns error code describing the result of calling, error code could
+  //! be:
+  //!     - std::errc::no_buffer_space (if the queue is full and the message
+  //!     was rejected according to the overflow policy).
+  //!     - std::errc::resource_unavailable_try_again (if the queue is full,
+  //!     the policy is kBlock and the producer is in NonBlockingPostScope).
+  //!     - std::errc::interrupted (if the producer was blocked on the full
+  //!     queue and SetInterruptFlag function was called with true).
+  //!     - std::errc::broken_pipe (if the queue is closed).
+  //!     - no error (if the message was enqueued).
+  //!
+  std::error_code Post(Message&& message, MessagePriority priority);
+
+  //!
+  //! Posts the messages to the lane of the specified priority taking the
+  //! queue lock once for the whole batch. Every message is subject to the
+  //! overflow policy on its own, so a part of the batch could be rejected.
+  //! The vector is cleared.
+  //!
+  //! Returns the last error of posting a single message or no error if all
+  //! messages were enqueued.
+  //!
+  std::error_code Post(std::vector<Message>& messages, MessagePriority priority);
 
   //!
-  //! Extracts a message from queue and assigns 'message' argument to
-  //! extracted value.
+  //! Extracts a batch of messages from queue and assigns 'messages' argument
+  //! to extracted values.
+  //!
+  //! The batch is filled starting from the highest priority lane: control
+  //! messages are always extracted entirely, the rest lanes share at most
+  //! kBatchSize messages. A lane which had pending messages but didn't get
+  //! into the batch for kStarvationLimit polls in a row gets the guaranteed
+  //! kStarvationQuota messages in the next batch before any other lane.
+  //!
+  //! The kInfiniteTimeout timeout waits until a message arrives or the
+  //! queue is interrupted.
   //!
   //! Returns error code describing the result of calling, error code could
   //! be:
   //!     - std::errc::timed_out (if reached 'timeout' value).
   //!     - std::errc::interrupted (if SetInterruptFlag function was called
   //!     with first parameter is true).
-  //!     - no error (if all is ok, in this case 'message' argument would
-  //!     contain a pointer to extracted message).
+  //!     - no error (if all is ok, in this case 'messages' argument would
+  //!     contain extracted messages).
   //!
   std::error_code Poll(std::vector<Message>& messages,
-                       const std::chrono::seconds& timeout = 0s) noexcept;
+                       const std::chrono::nanoseconds& timeout = 0ns) noexcept;
 
   void SetInterruptFlag(bool value) noexcept;
 
+  //!
+  //! Closes the queue to new messages: Post rejects them with
+  //! std::errc::broken_pipe (producers blocked on the full queue are woken
+  //! up with the same error). The pending messages still can be polled.
+  //!
+  void SetClosed(bool value) noexcept;
+
+  bool IsClosed() const noexcept;
+
+  //!
+  //! Sets the function waking up the consumer which waits for the queue
+  //! outside of Poll, e.g. in epoll_wait() together with the file
+  //! descriptors. The handler is called under the queue lock.
+  //!
+  void SetWakeupHandler(WakeupHandler handler);
+
+  //!
+  //! Called by the consumer before waiting outside of Poll. Returns false if
+  //! the consumer must not sleep: there are pending messages or the queue is
+  //! interrupted. Otherwise the next posted message, the interruption or the
+  //! closing of the queue calls the wakeup handler once.
+  //!
+  bool PrepareExternalWait() noexcept;
+
+  //!
+  //! Called by the consumer when the external wait is over.
+  //!
+  void FinishExternalWait() noexcept;
+
+  void SetLimits(const QueueLimits& limits);
+
+  //!
+  //! Sets how Poll waits for the messages, only the kAdaptive strategy and
+  //! its budgets change the wait of the queue itself, the rest strategies
+  //! are implemented by the event loop through the timeouts. Must be called
+  //! by the consumer thread.
+  //!
+  void SetWaitOptions(const WaitOptions& options) noexcept;
+
+  //!
+  //! Returns the statistics of the kAdaptive waits.
+  //!
+  WaitStats AdaptiveWaitStats() const noexcept;
+
+  //!
+  //! Sets the functions called with the current queue size when the size
+  //! crosses the watermarks. The handlers are called without the queue lock:
+  //! the high watermark handler from the producer thread and the low
+  //! watermark handler from the consumer thread.
+  //!
+  void SetWatermarkHandlers(WatermarkHandler on_high, WatermarkHandler on_low);
+
   void Clear() noexcept;
 
   size_t Size() const noexcept;
 
+  size_t Size(MessagePriority priority) const noexcept;
+
+  //!
+  //! Returns the number of messages dropped or coalesced because of the
+  //! overflow policy.
+  //!
+  size_t DroppedCount() const noexcept;
+
+  //!
+  //! Returns the number of messages enqueued since the queue was created.
+  //!
+  size_t PostedCount() const noexcept;
+
+  //!
+  //! Returns the max number of pending messages the queue ever had.
+  //!
+  size_t MaxSize() const noexcept;
+
+  //
+  // max number of non-control messages extracted by one Poll call, so the
+  // consumer returns to check the higher lanes at least every kBatchSize
+  // messages even if the lower lanes are flooded
+  //
+  static constexpr size_t kBatchSize = 1024;
+  static constexpr size_t kStarvationLimit = 8;
+  static constexpr size_t kStarvationQuota = kBatchSize / 8;
+
+  static constexpr auto kInfiniteTimeout = std::chrono::nanoseconds::max();
+
+ private:
+  struct Entry {
+    Message message;
+    std::optional<uint64_t> key;
+    size_t lane;
+    bool erased;
+  };
+
+  std::error_code Enqueue(std::unique_lock<std::recursive_mutex>& lock,
+                          Message&& message,
+                          size_t lane,
+                          WatermarkHandler& on_high_watermark);
+  bool Full() const noexcept;
+  std::error_code MakeRoom(std::unique_lock<std::recursive_mutex>& lock, size_t lane);
+  bool Coalesce(Message& message, size_t lane, std::optional<uint64_t>& key);
+  void Erase(Entry& entry);
+  void DropErased(size_t lane);
+  size_t LaneSize(size_t lane) const noexcept;
+  void PopFront(size_t lane);
+  void ExtractBatch(std::vector<Message>& messages);
+  void WakeExternalWaiter();
+  void WakeParkedConsumer() noexcept;
+  bool HasEventOrInterrupted() const noexcept;
+  bool WaitAdaptive(const std::chrono::nanoseconds& timeout) noexcept;
+  size_t Extract(size_t lane, size_t count, std::vector<Message>& messages);
+
  private:
   //
   // WARN: mutex must be recursive to avoid deadlock when handling SIGINT:
@@ -40,8 +280,43 @@ class MessageQueue {
   //
   mutable std::recursive_mutex mutex_;
   std::condition_variable_any condition_;
-  std::vector<Message> messages_;
-  bool interrupt_;
+  std::array<std::deque<Entry>, kMessagePrioritiesCount> lanes_;
+  //
+  // the number of the entries erased in the middle of each lane, see Erase
+  //
+  std::array<size_t, kMessagePrioritiesCount> erased_;
+  std::array<size_t, kMessagePrioritiesCount> starvation_;
+  std::unordered_map<uint64_t, Entry*> coalescing_;
+  //
+  // modified under the mutex, atomic to let a busy polling consumer check
+  // the queue without locking
+  //
+  std::atomic_size_t size_;
+  size_t dropped_;
+  size_t posted_;
+  size_t max_size_;
+  QueueLimits limits_;
+  WatermarkHandler on_high_watermark_;
+  WatermarkHandler on_low_watermark_;
+  WakeupHandler wakeup_handler_;
+  bool above_high_watermark_;
+  std::thread::id consumer_;
+  std::atomic_bool interrupt_;
+  bool closed_;
+  bool external_wait_;
+
+  //
+  // the adaptive wait, the options and the counters are written only by the
+  // consumer; the consumer sets the parked flag before sleeping on the
+  // wakeups futex, the producers bump the futex only if the flag is set
+  //
+  WaitOptions wait_options_;
+  std::atomic_bool parked_;
+  std::atomic_uint32_t wakeups_;
+  std::atomic_uint64_t spun_;
+  std::atomic_uint64_t yielded_;
+  std::atomic_uint64_t parked_count_;
+  std::atomic_uint64_t timed_out_;
 };
 
-}// namespace mdo
\ No newline at end of file
+}// namespace mdo
@@ -0,0 +1,172 @@
+#include "metrics.h"
+
+#include "atomic_helpers.h"
+#include "thread_data.h"
+
+namespace mdo {
+
+namespace {
+
+std::atomic_bool timings_enabled{false};
+
+//
+// the counters have the only writer, so the increment doesn't need the
+// locked read-modify-write instruction
+//
+void Increment(std::atomic_uint64_t& counter, uint64_t value = 1) noexcept {
+  StoreRelaxed(counter, LoadRelaxed(counter) + value);
+}
+
+void Maximize(std::atomic_uint64_t& counter, uint64_t value) noexcept {
+  if (LoadRelaxed(counter) < value) {
+    StoreRelaxed(counter, value);
+  }
+}
+
+std::string FormatDuration(const std::chrono::nanoseconds& duration) {
+  if (duration < 10us) {
+    return fmt::format("{}ns", duration.count());
+  }
+
+  if (duration < 10ms) {
+    return fmt::format("{}us", std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+  }
+
+  return fmt::format("{}ms", std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+}
+
+}// namespace
+
+void Metrics::SetTimingsEnabled(bool value) noexcept {
+  StoreRelease(timings_enabled, value);
+}
+
+bool Metrics::TimingsEnabled() noexcept { return LoadRelaxed(timings_enabled); }
+
+std::vector<ThreadMetricsSnapshot> Metrics::Collect() {
+  std::vector<ThreadMetricsSnapshot> snapshots;
+
+  ThreadData::ForEach([&snapshots](const ThreadData& data) {
+    snapshots.push_back(data.MetricsSnapshot());
+  });
+
+  return snapshots;
+}
+
+std::string Metrics::Format(const ThreadMetricsSnapshot& snapshot) {
+  auto result = fmt::format(
+    "thread '{}': posted {}, handled {}, dropped {}, queue depth {} (max {})",
+    snapshot.thread,
+    snapshot.posted,
+    snapshot.handled,
+    snapshot.dropped,
+    snapshot.queue_depth,
+    snapshot.queue_depth_high_watermark);
+
+  if (snapshot.latency.Count()) {
+    result += fmt::format(
+      "\n  latency: p50 {}, p90 {}, p99 {}, p99.9 {}, max {} ({} samples)",
+      FormatDuration(snapshot.latency.Percentile(50)),
+      FormatDuration(snapshot.latency.Percentile(90)),
+      FormatDuration(snapshot.latency.Percentile(99)),
+      FormatDuration(snapshot.latency.Percentile(99.9)),
+      FormatDuration(snapshot.latency.Max()),
+      snapshot.latency.Count());
+  }
+
+  if (const auto& wait = snapshot.wait; wait.spun || wait.yielded || wait.parked || wait.timed_out) {
+    result += fmt::format(
+      "\n  wait: spun {}, yielded {}, parked {}, timed out {}",
+      wait.spun,
+      wait.yielded,
+      wait.parked,
+      wait.timed_out);
+  }
+
+  for (const auto& handler : snapshot.handlers) {
+    result += fmt::format(
+      "\n  handler '{}': calls {}, total {}, avg {}, max {}",
+      handler.type,
+      handler.calls,
+      FormatDuration(handler.total),
+      FormatDuration(handler.total / std::max<uint64_t>(handler.calls, 1)),
+      FormatDuration(handler.max));
+  }
+
+  return result;
+}
+
+namespace details {
+
+void ThreadMetrics::OnHandled() noexcept { Increment(handled_); }
+
+void ThreadMetrics::OnHandled(const std::type_info& type, const std::chrono::nanoseconds& handling) noexcept {
+  const auto ns = static_cast<uint64_t>(handling.count());
+  auto& handler = Handler(type);
+
+  Increment(handled_);
+  Increment(handler.calls);
+  Increment(handler.total, ns);
+  Maximize(handler.max, ns);
+}
+
+void ThreadMetrics::OnLatency(const std::chrono::nanoseconds& latency) noexcept {
+  Increment(latency_[Histogram::BucketIndex(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)))]);
+}
+
+void ThreadMetrics::Collect(ThreadMetricsSnapshot& snapshot) const {
+  snapshot.handled = LoadRelaxed(handled_);
+
+  for (size_t bucket = 0; bucket < Histogram::kBucketCount; ++bucket) {
+    snapshot.latency.RecordBucket(bucket, LoadRelaxed(latency_[bucket]));
+  }
+
+  for (const auto& handler : handlers_) {
+    const auto calls = LoadRelaxed(handler.calls);
+
+    if (!calls) {
+      continue;
+    }
+
+    const auto type = LoadAcquire(handler.type);
+
+    snapshot.handlers.push_back({
+      .type = type ? type->name() : "<other>",
+      .calls = calls,
+      .total = std::chrono::nanoseconds{LoadRelaxed(handler.total)},
+      .max = std::chrono::nanoseconds{LoadRelaxed(handler.max)},
+    });
+  }
+
+  std::sort(snapshot.handlers.begin(), snapshot.handlers.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.total > rhs.total;
+  });
+}
+
+ThreadMetrics::HandlerCounters& ThreadMetrics::Handler(const std::type_info& type) noexcept {
+  const auto start = type.hash_code() % kMaxHandlerTypes;
+
+  for (size_t i = 0; i < kMaxHandlerTypes; ++i) {
+    auto& handler = handlers_[(start + i) % kMaxHandlerTypes];
+    const auto handler_type = LoadRelaxed(handler.type);
+
+    if (handler_type == &type || (handler_type && *handler_type == type)) {
+      return handler;
+    }
+
+    //
+    // the type is published after the counters are zeroed, so a reader never
+    // attributes the counters to a wrong type
+    //
+    if (!handler_type) {
+      StoreRelease(handler.type, &type);
+      return handler;
+    }
+  }
+
+  return handlers_[kMaxHandlerTypes];
+}
+
+}// namespace details
+
+}// namespace mdo
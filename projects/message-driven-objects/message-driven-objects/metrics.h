@@ -0,0 +1,123 @@
+#pragma once
+
+#include "histogram.h"
+#include "wait_strategy.h"
+
+namespace mdo {
+
+struct HandlerMetrics {
+  //!
+  //! The mangled name of the receiver's dynamic type.
+  //!
+  std::string type;
+  uint64_t calls = 0;
+  std::chrono::nanoseconds total{};
+  std::chrono::nanoseconds max{};
+};
+
+struct ThreadMetricsSnapshot {
+  //!
+  //! The name of the thread or its id if the name isn't set.
+  //!
+  std::string thread;
+
+  size_t posted = 0;
+  size_t handled = 0;
+  size_t dropped = 0;
+  size_t queue_depth = 0;
+  size_t queue_depth_high_watermark = 0;
+
+  //!
+  //! Time between posting a message and calling its handler. Collected only
+  //! when the timings are enabled, see Metrics::SetTimingsEnabled().
+  //!
+  Histogram latency;
+
+  //!
+  //! Time spent in the handlers per the receiver type, sorted by the total
+  //! time descending. Collected only when the timings are enabled.
+  //!
+  std::vector<HandlerMetrics> handlers;
+
+  //!
+  //! The stages of the waits for the messages, collected only with the
+  //! WaitStrategy::kAdaptive strategy.
+  //!
+  WaitStats wait;
+};
+
+//!
+//! The runtime metrics of the threads.
+//!
+//! The counters of a thread are written only by the thread itself into its
+//! own cache line padded block, without atomic read-modify-write operations
+//! and locks, and are aggregated when a snapshot is requested. The posted,
+//! dropped and queue depth counters are maintained by the queue under its
+//! lock which is taken anyway.
+//!
+//! The message counters are always collected. The timings cost three clock
+//! reads per message and are disabled by default.
+//!
+class Metrics final {
+ public:
+  static void SetTimingsEnabled(bool value) noexcept;
+  static bool TimingsEnabled() noexcept;
+
+  //!
+  //! Returns the snapshots of the metrics of all threads which have a
+  //! message queue, including the adopted ones.
+  //!
+  static std::vector<ThreadMetricsSnapshot> Collect();
+
+  //!
+  //! Formats the snapshot as a multiline human readable report.
+  //!
+  static std::string Format(const ThreadMetricsSnapshot& snapshot);
+};
+
+namespace details {
+
+inline constexpr size_t kCacheLineSize = 64;
+
+//!
+//! The counters of a thread's event loop. All members are written only by
+//! the owner thread, other threads only read them.
+//!
+class alignas(kCacheLineSize) ThreadMetrics {
+ public:
+  static constexpr size_t kMaxHandlerTypes = 64;
+
+  void OnHandled() noexcept;
+  void OnHandled(const std::type_info& type, const std::chrono::nanoseconds& handling) noexcept;
+  void OnLatency(const std::chrono::nanoseconds& latency) noexcept;
+
+  void Collect(ThreadMetricsSnapshot& snapshot) const;
+
+ private:
+  struct HandlerCounters {
+    std::atomic<const std::type_info*> type;
+    std::atomic_uint64_t calls;
+    std::atomic_uint64_t total;
+    std::atomic_uint64_t max;
+  };
+
+  HandlerCounters& Handler(const std::type_info& type) noexcept;
+
+ private:
+  std::atomic_uint64_t handled_{};
+  //
+  // the buckets of the Histogram, it can't be used directly because the
+  // snapshot is read by other threads
+  //
+  std::array<std::atomic_uint64_t, Histogram::kBucketCount> latency_{};
+
+  //
+  // open addressing by the type hash, the types which didn't fit are
+  // accounted in the last overflow entry without a type
+  //
+  std::array<HandlerCounters, kMaxHandlerTypes + 1> handlers_{};
+};
+
+}// namespace details
+
+}// namespace mdo
@@ -0,0 +1,24 @@
+#include "metrics_reporter.h"
+
+#include "metrics.h"
+#include "timer_message.h"
+
+namespace mdo {
+
+MetricsReporter::MetricsReporter(mdo::Thread* thread, const std::chrono::nanoseconds& interval)
+    : Object{thread},
+      timer_id_{StartTimer(interval)} {}
+
+void MetricsReporter::Report() {
+  for (const auto& snapshot : Metrics::Collect()) {
+    LOG_INFO("{}", Metrics::Format(snapshot));
+  }
+}
+
+void MetricsReporter::OnTimerMessage(TimerMessage& message) {
+  if (message.Id() == timer_id_) {
+    Report();
+  }
+}
+
+}// namespace mdo
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "object.h"
+
+namespace mdo {
+
+//!
+//! Periodically writes the metrics of all threads to the log with the info
+//! level. The reporter lives in the given thread and uses its timers, so the
+//! thread must be running:
+//!
+//!   Metrics::SetTimingsEnabled(true);
+//!   const auto reporter = MakeUnique<MetricsReporter>(thread.get(), 10s);
+//!
+class MetricsReporter : public Object {
+ public:
+  MetricsReporter(mdo::Thread* thread, const std::chrono::nanoseconds& interval);
+
+  //!
+  //! Writes the metrics right now.
+  //!
+  static void Report();
+
+ protected:
+  void OnTimerMessage(TimerMessage& message) override;
+
+ private:
+  int timer_id_;
+};
+
+}// namespace mdo
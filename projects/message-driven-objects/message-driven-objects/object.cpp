@@ -1,82 +1,156 @@
 #include "object.h"
 
+#include "atomic_helpers.h"
 #include "invoke_slot_message.h"
 #include "message.h"
 #include "objects_registry.h"
 #include "overloaded.h"
+#include "strand.h"
 #include "thread.h"
+#include "thread_data.h"
 #include "timer_service.h"
 
+namespace {
+
+thread_local mdo::Object* current_object = nullptr;
+
+}// namespace
+
 namespace mdo {
 
+const std::shared_ptr<Strand>& GetStrand(const Object* object) noexcept {
+  return object->strand_;
+}
+
 Object::Object() : Object{Thread::Current()} {}
 
-Object::Object(mdo::Thread* thread) : thread_{thread} {
+Object::Object(mdo::Thread* thread)
+    : thread_{thread},
+      pool_{} {
   if (!Thread()) {
     thread_ = Thread::Current();
   }
 
-  ObjectsRegistry::Instance().RegisterObject(this);
+  handle_ = ObjectsRegistry::Instance().Register(this);
+}
+
+Object::Object(ThreadPool* pool)
+    : thread_{},
+      pool_{pool},
+      strand_{std::make_shared<Strand>()} {
+  assert(pool_ && "the pool must be specified");
+
+  handle_ = ObjectsRegistry::Instance().Register(this);
 }
 
 Object::~Object() {
+  Retire();
+
   std::scoped_lock _{mutex_};
 
-  for (const auto& id : timers_) {
-    TimerService::Instance()->RemoveTimer(id);
+  for (const auto& [id, local_timers_owner] : timers_) {
+    if (local_timers_owner) {
+      local_timers_owner->Timers().Remove(id);
+    } else {
+      TimerService::Instance()->RemoveTimer(id);
+    }
   }
 
   timers_.clear();
+}
+
+Object* Object::Current() noexcept { return current_object; }
+
+const ObjectHandle& Object::Handle() const noexcept { return handle_; }
 
-  ObjectsRegistry::Instance().UnregisterObject(this);
+void Object::Retire() noexcept {
+  ObjectsRegistry::Instance().Unregister(handle_);
 }
 
-int Object::StartTimer(const std::chrono::milliseconds& ms) noexcept {
-  const auto id = TimerService::Instance()->AddTimer(this, ms);
+int Object::StartTimer(const std::chrono::nanoseconds& interval) noexcept {
+  const auto thread = Thread();
+
+  //
+  // the timer started by the object in its own thread is evaluated by the
+  // thread's event loop, otherwise the ticks come from TimerService
+  //
+  if (thread && thread == Thread::Current()) {
+    auto data = GetThreadData(thread);
+    const auto id = data->Timers().Add(this, interval);
+
+    std::scoped_lock _{mutex_};
+    timers_.emplace(id, std::move(data));
+
+    return id;
+  }
+
+  const auto id = TimerService::Instance()->AddTimer(this, interval);
 
   {
     std::scoped_lock _{mutex_};
-    timers_.insert(id);
+    timers_.emplace(id, nullptr);
   }
 
   return id;
 }
 
 void Object::KillTimer(int id) noexcept {
+  std::shared_ptr<ThreadData> local_timers_owner;
+
   {
     std::scoped_lock _{mutex_};
-    timers_.erase(id);
+    const auto it = timers_.find(id);
+
+    if (it == timers_.end()) {
+      return;
+    }
+
+    local_timers_owner = std::move(it->second);
+    timers_.erase(it);
   }
 
-  TimerService::Instance()->RemoveTimer(id);
+  if (local_timers_owner) {
+    local_timers_owner->Timers().Remove(id);
+  } else {
+    TimerService::Instance()->RemoveTimer(id);
+  }
 }
 
 void Object::ResetTimer(int id) const noexcept {
-  assert(timers_.find(id) != timers_.end());
-  TimerService::Instance()->ResetTimer(id);
+  std::scoped_lock _{mutex_};
+  const auto it = timers_.find(id);
+
+  assert(it != timers_.end());
+
+  if (it->second) {
+    it->second->Timers().Reset(id);
+  } else {
+    TimerService::Instance()->ResetTimer(id);
+  }
 }
 
 void Object::OnMessage(Message& message) {
+  const auto previous_object = std::exchange(current_object, this);
+
   std::visit(
     Overloaded{
       [this](InvokeSlotMessage& msg) { OnInvokeSlotMessage(msg); },
       [this](TestMessage& msg) { OnTestMessage(msg); },
       [this](BenchmarkMessage& msg) { OnBenchmarkMessage(msg); },
       [this](TimerMessage& msg) { OnTimerMessage(msg); },
+      [this](AnyMessage& msg) { OnAnyMessage(msg); },
       [](SetThreadNameMessage&) { abort(); },
       [](std::monostate&) { abort(); }},
     message);
-}
 
-mdo::Thread* Object::Thread() const noexcept {
-  std::scoped_lock _{mutex_};
-  return thread_;
+  current_object = previous_object;
 }
 
-void Object::SetThread(mdo::Thread* thread) {
-  std::scoped_lock _{mutex_};
-  thread_ = thread;
-}
+mdo::Thread* Object::Thread() const noexcept { return LoadAcquire(thread_); }
+
+ThreadPool* Object::Pool() const noexcept { return pool_; }
+
+void Object::SetThread(mdo::Thread* thread) { StoreRelease(thread_, thread); }
 
 void Object::OnBenchmarkMessage(BenchmarkMessage&) {}
 
@@ -84,6 +158,10 @@ void Object::OnTimerMessage(TimerMessage&) {}
 
 void Object::OnTestMessage(TestMessage&) {}
 
+void Object::OnAnyMessage(AnyMessage& message) {
+  LOG_WARNING("message of type '{}' is not handled by the receiver", message.TypeName());
+}
+
 void Object::OnInvokeSlotMessage(InvokeSlotMessage& message) {
   message.Invoke();
 }
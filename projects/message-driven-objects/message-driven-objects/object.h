@@ -5,10 +5,14 @@
 namespace mdo {
 
 class Thread;
+class ThreadData;
+class ThreadPool;
+class Strand;
 class InvokeSlotMessage;
 class TimerMessage;
 class BenchmarkMessage;
 class TestMessage;
+class AnyMessage;
 
 /*!
 
@@ -23,27 +27,66 @@ class TestMessage;
  calls 'Object::OnMessage => Object::OnTextMessage' for object B.
 
  The developer must ensure that the object is deleted before the thread to be
- sure that Thread* thread_ in the Object's object is valid. Also developer
- usually should to stop the thread manually before the object that lives in this
- thread is deleted.
+ sure that Thread* thread_ in the Object's object is valid. The thread doesn't
+ need to be stopped before the object is deleted if the object is retired
+ first (see below).
+
+ An object can be bound to a ThreadPool instead of a thread. Such object has no
+ thread affinity: its messages are handled by any of the pool workers but one
+ at a time and in the order they were posted.
+
+ Each message carries the handle of its receiver and is delivered only if the
+ handle is still alive. An object retires its handle in ~Object, but at that
+ point the derived part of the object is already destroyed while a handler
+ running in another thread could still use it. To avoid this the object must
+ be retired before the derived destructors run: either call Retire() at the
+ beginning of the most derived destructor or destroy the object using
+ ObjectDeleter (MakeUnique and MakeShared do it).
 
 */
 
 class Object {
  public:
+  friend const std::shared_ptr<Strand>&
+  GetStrand(const Object* object) noexcept;
+
   Object();
   explicit Object(mdo::Thread* thread);
+  explicit Object(ThreadPool* pool);
 
   virtual ~Object();
 
+  //!
+  //! Returns the object whose message is being handled by the calling thread
+  //! or nullptr if the thread doesn't handle any message right now.
+  //!
+  static Object* Current() noexcept;
+
+  //!
+  //! Returns the handle which is used to check if the object is alive.
+  //!
+  [[nodiscard]] const ObjectHandle& Handle() const noexcept;
+
+  //!
+  //! Makes the handle of the object stale, so no more messages are delivered
+  //! to the object, and waits until the handlers of the object running in the
+  //! other threads return.
+  //!
+  //! Calling Retire() more than once does nothing.
+  //!
+  void Retire() noexcept;
+
   //!
   //! Starts a timer and returns a timer identifier.
-  //! A timer message will occur every interval milliseconds until KillTimer()
+  //! A timer message will occur every interval until KillTimer()
   //! is called. The virtual OnTimerMessage() function is called with the
   //! TimerMessage message parameter class when a timer message occurs.
   //! Reimplement this function to get timer messages.
   //!
-  int StartTimer(const std::chrono::milliseconds& ms) noexcept;
+  //! A timer started in the object's own thread is evaluated by the event
+  //! loop of that thread, so its ticks never cross threads.
+  //!
+  int StartTimer(const std::chrono::nanoseconds& interval) noexcept;
 
   //!
   //! Kills the timer with timer identifier, id.
@@ -64,9 +107,16 @@ class Object {
 
   //!
   //! Returns the pointer to the thread where this object "lives".
+  //! Returns nullptr if the object is bound to a ThreadPool.
   //!
   [[nodiscard]] mdo::Thread* Thread() const noexcept;
 
+  //!
+  //! Returns the pointer to the pool which handles messages of this object or
+  //! nullptr if the object lives in a thread.
+  //!
+  [[nodiscard]] ThreadPool* Pool() const noexcept;
+
  protected:
   void SetThread(mdo::Thread* thread);
 
@@ -74,6 +124,13 @@ class Object {
   virtual void OnBenchmarkMessage(BenchmarkMessage& message);
   virtual void OnTestMessage(TestMessage& message);
 
+  //!
+  //! Receives messages with application defined payloads.
+  //! Reimplement this function and dispatch the message using
+  //! MessageHandlers to handle them.
+  //!
+  virtual void OnAnyMessage(AnyMessage& message);
+
  private:
   void OnInvokeSlotMessage(InvokeSlotMessage& message);
 
@@ -85,8 +142,44 @@ class Object {
   // example call of Dispatcher::Quit), then would be deadlock.
   //
   mutable std::recursive_mutex mutex_;
-  mdo::Thread* thread_;
-  std::set<int> timers_;
+  //
+  // read on every dispatched message, so it's atomic rather than guarded by
+  // the mutex
+  //
+  std::atomic<mdo::Thread*> thread_;
+  ThreadPool* pool_;
+  std::shared_ptr<Strand> strand_;
+  ObjectHandle handle_;
+
+  //
+  // timer id -> data of the thread whose local timers contain the timer or
+  // nullptr if the timer belongs to TimerService
+  //
+  std::map<int, std::shared_ptr<ThreadData>> timers_;
+};
+
+//!
+//! Retires the object before deleting it, so the derived part of the object
+//! isn't destroyed while its message handler runs in another thread.
+//!
+struct ObjectDeleter {
+  void operator()(Object* object) const noexcept {
+    object->Retire();
+    delete object;
+  }
 };
 
+template <typename T>
+using ObjectPtr = std::unique_ptr<T, ObjectDeleter>;
+
+template <typename T, typename... Args>
+ObjectPtr<T> MakeUnique(Args&&... args) {
+  return ObjectPtr<T>{new T(std::forward<Args>(args)...)};
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeShared(Args&&... args) {
+  return std::shared_ptr<T>{new T(std::forward<Args>(args)...), ObjectDeleter{}};
+}
+
 }// namespace mdo
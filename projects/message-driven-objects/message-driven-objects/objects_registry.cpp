@@ -0,0 +1,187 @@
+#include "objects_registry.h"
+
+#include "thread.h"
+
+namespace {
+
+//
+// indexes of the slots pinned by the current thread, they are not waited
+// for when the thread unregisters an object
+//
+thread_local std::vector<uint32_t> pinned_slots;
+
+}// namespace
+
+namespace mdo {
+
+ObjectsRegistry::ObjectsRegistry()
+    : chunks_{},
+      slots_count_{},
+      size_{} {}
+
+ObjectsRegistry::~ObjectsRegistry() {
+  for (auto& chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+Object* ObjectHandle::Get() const noexcept { return ObjectsRegistry::Instance().Get(*this); }
+
+bool ObjectHandle::IsAlive() const noexcept { return ObjectsRegistry::Instance().IsAlive(*this); }
+
+ObjectHandle ObjectsRegistry::Register(NotNull<Object*> object) {
+  std::scoped_lock _{mutex_};
+
+  uint32_t index = 0;
+
+  if (!free_slots_.empty()) {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    index = slots_count_++;
+
+    const auto chunk_index = index / kChunkSize;
+
+    if (chunk_index >= kMaxChunks) {
+      LOG_CRITICAL("too many objects, max number of objects is '{}'", kMaxObjects);
+      std::terminate();
+    }
+
+    if (!chunks_[chunk_index].load(std::memory_order_relaxed)) {
+      chunks_[chunk_index].store(new Slot[kChunkSize]{}, std::memory_order_release);
+    }
+  }
+
+  ++size_;
+
+  auto& slot = SlotAt(index);
+  slot.object.store(object, std::memory_order_release);
+
+  return ObjectHandle{index, Generation(slot.state.load(std::memory_order_acquire))};
+}
+
+void ObjectsRegistry::Unregister(const ObjectHandle& handle) {
+  if (!handle) {
+    return;
+  }
+
+  auto& slot = SlotAt(handle.index);
+  auto state = slot.state.load(std::memory_order_acquire);
+
+  do {
+    if (Generation(state) != handle.generation) {
+      return;
+    }
+  } while (!slot.state.compare_exchange_weak(state, state + (uint64_t{1} << 32), std::memory_order_acq_rel));
+
+  const auto own_pins = static_cast<uint32_t>(std::count(pinned_slots.begin(), pinned_slots.end(), handle.index));
+
+  const auto started = std::chrono::steady_clock::now();
+  auto warned = false;
+
+  while (Pins(slot.state.load(std::memory_order_acquire)) > own_pins) {
+    //
+    // a pin holder blocked on the calling thread never releases its pin, so
+    // the long waits are reported to make such a deadlock visible
+    //
+    if (!warned && std::chrono::steady_clock::now() - started > kUnregisterWarningTimeout) {
+      LOG_WARNING("unregistration of object '{}' waits for '{}' pins for more than '{}' seconds",
+                  (void*) slot.object.load(std::memory_order_relaxed),
+                  Pins(slot.state.load(std::memory_order_relaxed)) - own_pins,
+                  kUnregisterWarningTimeout.count());
+      warned = true;
+    }
+
+    Thread::YieldThread();
+  }
+
+  slot.object.store(nullptr, std::memory_order_relaxed);
+
+  std::scoped_lock _{mutex_};
+  free_slots_.push_back(handle.index);
+  --size_;
+}
+
+bool ObjectsRegistry::IsAlive(const ObjectHandle& handle) const noexcept {
+  return handle && Generation(SlotAt(handle.index).state.load(std::memory_order_acquire)) == handle.generation;
+}
+
+Object* ObjectsRegistry::Get(const ObjectHandle& handle) const noexcept {
+  if (!handle) {
+    return nullptr;
+  }
+
+  const auto& slot = SlotAt(handle.index);
+  const auto object = slot.object.load(std::memory_order_acquire);
+
+  //
+  // the generation is checked after reading the object, so the object can't
+  // belong to the next owner of the slot
+  //
+  return Generation(slot.state.load(std::memory_order_acquire)) == handle.generation ? object : nullptr;
+}
+
+bool ObjectsRegistry::Pin(const ObjectHandle& handle) {
+  if (!handle) {
+    return false;
+  }
+
+  //
+  // the pin is recorded before it's taken, so a failed allocation can't leave
+  // a pin that the calling thread doesn't know about
+  //
+  pinned_slots.push_back(handle.index);
+
+  auto& slot = SlotAt(handle.index);
+  auto state = slot.state.load(std::memory_order_acquire);
+
+  do {
+    if (Generation(state) != handle.generation) {
+      pinned_slots.pop_back();
+      return false;
+    }
+  } while (!slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel));
+
+  return true;
+}
+
+void ObjectsRegistry::Unpin(const ObjectHandle& handle) noexcept {
+  //
+  // the pins are released in the reverse order
+  //
+  assert(!pinned_slots.empty() && pinned_slots.back() == handle.index);
+  pinned_slots.pop_back();
+
+  SlotAt(handle.index).state.fetch_sub(1, std::memory_order_release);
+}
+
+size_t ObjectsRegistry::Size() const noexcept {
+  std::scoped_lock _{mutex_};
+  return size_;
+}
+
+ObjectsRegistry::Slot& ObjectsRegistry::SlotAt(uint32_t index) const noexcept {
+  return chunks_[index / kChunkSize].load(std::memory_order_acquire)[index % kChunkSize];
+}
+
+ObjectPin::ObjectPin(const ObjectHandle& handle)
+    : handle_{handle},
+      object_{} {
+  auto& registry = ObjectsRegistry::Instance();
+
+  if (registry.Pin(handle)) {
+    object_ = registry.SlotAt(handle.index).object.load(std::memory_order_acquire);
+  }
+}
+
+ObjectPin::~ObjectPin() {
+  if (object_) {
+    ObjectsRegistry::Instance().Unpin(handle_);
+  }
+}
+
+ObjectPin::operator bool() const noexcept { return object_; }
+
+Object* ObjectPin::Get() const noexcept { return object_; }
+
+}// namespace mdo
@@ -6,6 +6,54 @@ namespace mdo {
 
 class Object;
 
+//!
+//! Generation-counted reference to a registered Object.
+//!
+//! The handle refers to the slot of the object in ObjectsRegistry and
+//! remembers the generation of the slot at the moment of registration. When
+//! the object is unregistered the generation of the slot is incremented, so
+//! all handles of the object become stale even if the slot is reused by
+//! another object.
+//!
+//! Messages and signal connections hold handles instead of raw pointers, so
+//! they can outlive their receivers.
+//!
+struct ObjectHandle {
+  static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = kInvalidIndex;
+  uint32_t generation = 0;
+
+  explicit operator bool() const noexcept { return index != kInvalidIndex; }
+
+  //!
+  //! Returns the object or nullptr if the handle is stale.
+  //!
+  //! Note: the object may be retired right after the call, use ObjectPin to
+  //! access the object of a handle that was obtained from another thread.
+  //!
+  [[nodiscard]] Object* Get() const noexcept;
+
+  [[nodiscard]] bool IsAlive() const noexcept;
+
+  friend bool operator==(const ObjectHandle& lhs, const ObjectHandle& rhs) = default;
+};
+
+//!
+//! Registry of alive objects used to check the liveness of the message
+//! receivers without any global lock.
+//!
+//! Each object occupies a slot holding the generation of the slot and the
+//! number of pins in one atomic word. Delivering a message pins the slot with
+//! a single CAS which fails if the handle is stale. Unregistering an object
+//! increments the generation (so no new pins succeed) and waits until the
+//! pins taken by other threads are released, i.e. until the handlers already
+//! running for the object return.
+//!
+//! Only registration and unregistration lock the registry mutex, the slots
+//! are allocated in chunks which are never freed, so a slot can be read
+//! concurrently with the registration of other objects.
+//!
 class ObjectsRegistry {
  public:
   static ObjectsRegistry& Instance() {
@@ -22,43 +70,113 @@ class ObjectsRegistry {
   ObjectsRegistry(ObjectsRegistry&& other) = delete;
   ObjectsRegistry(const ObjectsRegistry& other) = delete;
 
-  virtual ~ObjectsRegistry() {
-    if (!objects_.empty()) {
-      // Logger()->error("ObjectsRegistry destroys but some Objects is
-      // still alive");
-    }
-  }
+  virtual ~ObjectsRegistry();
 
-  const std::set<Object*>& Objects() const noexcept {
-    std::scoped_lock _{*this};
-    return objects_;
-  }
+  ObjectHandle Register(NotNull<Object*> object);
 
-  void RegisterObject(NotNull<Object*> object) {
-    std::scoped_lock _{*this};
-    objects_.insert(object);
-  }
+  //!
+  //! Makes the handle stale and waits until the pins of the object taken by
+  //! other threads are released. The pins taken by the calling thread are
+  //! not waited for, so an object can unregister itself from its own
+  //! message handler. Does nothing if the handle is already stale.
+  //!
+  //! Note: The wait is unbounded, a warning is logged if it takes longer
+  //! than kUnregisterWarningTimeout (see ObjectPin for the constraints).
+  //!
+  void Unregister(const ObjectHandle& handle);
 
-  void UnregisterObject(NotNull<Object*> object) {
-    std::scoped_lock _{*this};
-    objects_.erase(object);
-  }
+  bool IsAlive(const ObjectHandle& handle) const noexcept;
 
-  bool HasObject(NotNull<Object*> object) {
-    std::scoped_lock _{*this};
-    return objects_.contains(object);
-  }
+  Object* Get(const ObjectHandle& handle) const noexcept;
 
-  void lock() const noexcept { mutex_.lock(); }
+  //!
+  //! Prevents the unregistration of the object from returning until Unpin
+  //! is called. Returns false if the handle is stale.
+  //!
+  //! Note: This function is lock-free, but it can throw std::bad_alloc
+  //! while recording the pin for the calling thread.
+  //!
+  bool Pin(const ObjectHandle& handle);
 
-  void unlock() const noexcept { mutex_.unlock(); }
+  void Unpin(const ObjectHandle& handle) noexcept;
+
+  //!
+  //! Returns the number of registered objects.
+  //!
+  size_t Size() const noexcept;
 
  private:
-  ObjectsRegistry() = default;
+  friend class ObjectPin;
+
+  ObjectsRegistry();
+
+  struct Slot {
+    //
+    // generation in the high 32 bits, number of pins in the low 32 bits
+    //
+    std::atomic<uint64_t> state;
+    std::atomic<Object*> object;
+  };
+
+  static constexpr size_t kChunkSize = 4096;
+  static constexpr size_t kMaxChunks = 4096;
+
+ public:
+  //!
+  //! Max number of simultaneously registered objects, the index of a handle
+  //! always fits into 24 bits.
+  //!
+  static constexpr size_t kMaxObjects = kChunkSize * kMaxChunks;
+
+  //!
+  //! Time after which a waiting Unregister reports the pins that hold it.
+  //!
+  static constexpr std::chrono::seconds kUnregisterWarningTimeout{5};
+
+ private:
+  static uint32_t Generation(uint64_t state) noexcept { return static_cast<uint32_t>(state >> 32); }
+
+  static uint32_t Pins(uint64_t state) noexcept { return static_cast<uint32_t>(state); }
+
+  Slot& SlotAt(uint32_t index) const noexcept;
+
+ private:
+  mutable std::mutex mutex_;
+  std::array<std::atomic<Slot*>, kMaxChunks> chunks_;
+  std::vector<uint32_t> free_slots_;
+  uint32_t slots_count_;
+  size_t size_;
+};
+
+//!
+//! Pins the object for the lifetime of the ObjectPin (see ObjectsRegistry::Pin).
+//!
+//! Note: The thread unregistering the object waits for the pin, so while
+//! holding it never block on that thread (e.g. posting with the kBlock
+//! policy to its full queue, or joining it), otherwise both threads hang.
+//!
+class ObjectPin final {
+ public:
+  explicit ObjectPin(const ObjectHandle& handle);
+
+  ObjectPin(const ObjectPin& other) = delete;
+  ObjectPin& operator=(const ObjectPin& other) = delete;
+
+  ~ObjectPin();
+
+  //!
+  //! Returns false if the object was dead and isn't pinned.
+  //!
+  explicit operator bool() const noexcept;
+
+  //!
+  //! Returns the pinned object or nullptr if the object was dead.
+  //!
+  [[nodiscard]] Object* Get() const noexcept;
 
  private:
-  mutable std::recursive_mutex mutex_;
-  std::set<Object*> objects_;
+  ObjectHandle handle_;
+  Object* object_;
 };
 
-}// namespace mdo
\ No newline at end of file
+}// namespace mdo
@@ -0,0 +1,31 @@
+#include "shared_buffer.h"
+
+namespace mdo {
+
+SharedBuffer::SharedBuffer(size_t size)
+    : data_{size ? std::make_shared_for_overwrite<std::byte[]>(size) : nullptr},
+      size_{size} {}
+
+SharedBuffer::SharedBuffer(std::span<const std::byte> bytes) : SharedBuffer{bytes.size()} {
+  if (size_) {
+    std::memcpy(data_.get(), bytes.data(), size_);
+  }
+}
+
+SharedBuffer::SharedBuffer(std::string_view bytes) : SharedBuffer{std::as_bytes(std::span{bytes})} {}
+
+const std::byte* SharedBuffer::Data() const noexcept { return data_.get(); }
+
+size_t SharedBuffer::Size() const noexcept { return size_; }
+
+bool SharedBuffer::Empty() const noexcept { return !size_; }
+
+std::span<const std::byte> SharedBuffer::Bytes() const noexcept { return {data_.get(), size_}; }
+
+std::string_view SharedBuffer::View() const noexcept {
+  return {reinterpret_cast<const char*>(data_.get()), size_};
+}
+
+long SharedBuffer::UseCount() const noexcept { return data_.use_count(); }
+
+}// namespace mdo
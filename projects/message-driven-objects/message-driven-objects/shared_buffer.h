@@ -0,0 +1,62 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Immutable reference counted byte buffer.
+//!
+//! Copying the buffer copies the reference, not the bytes, so a large
+//! payload emitted to many receivers or posted to many threads is shared by
+//! all of them: a 64 KB snapshot sent to 10 consumers costs 10 reference
+//! increments instead of 640 KB of copies. The bytes are never changed after
+//! the buffer is built, so the receivers read them without synchronization.
+//! The bytes and the counter are allocated in one block.
+//!
+//!   const auto snapshot = SharedBuffer::Build(size, [&](std::span<std::byte> bytes) {
+//!     book.Serialize(bytes);
+//!   });
+//!
+//!   SnapshotReady(snapshot);
+//!
+class SharedBuffer final {
+ public:
+  SharedBuffer() noexcept = default;
+
+  //!
+  //! Copies the bytes into a new buffer.
+  //!
+  explicit SharedBuffer(std::span<const std::byte> bytes);
+  explicit SharedBuffer(std::string_view bytes);
+
+  //!
+  //! Allocates the buffer of the size and lets fill(std::span<std::byte>)
+  //! write the bytes in place, the only time they can be written.
+  //!
+  template <typename Fill>
+  static SharedBuffer Build(size_t size, Fill&& fill) {
+    SharedBuffer buffer{size};
+    std::forward<Fill>(fill)(std::span<std::byte>{buffer.data_.get(), size});
+    return buffer;
+  }
+
+  [[nodiscard]] const std::byte* Data() const noexcept;
+  [[nodiscard]] size_t Size() const noexcept;
+  [[nodiscard]] bool Empty() const noexcept;
+
+  [[nodiscard]] std::span<const std::byte> Bytes() const noexcept;
+  [[nodiscard]] std::string_view View() const noexcept;
+
+  //!
+  //! Returns the number of the buffers sharing the bytes.
+  //!
+  [[nodiscard]] long UseCount() const noexcept;
+
+ private:
+  explicit SharedBuffer(size_t size);
+
+ private:
+  std::shared_ptr<std::byte[]> data_;
+  size_t size_ = 0;
+};
+
+}// namespace mdo
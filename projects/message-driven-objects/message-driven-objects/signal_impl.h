@@ -1,6 +1,10 @@
 #pragma once
 
+#include "connection.h"
+#include "connection_type.h"
+#include "delivery_mode.h"
 #include "dispatcher.h"
+#include "emit_epochs.h"
 #include "invoke_slot_message.h"
 #include "not_null.h"
 #include "object.h"
@@ -8,6 +12,323 @@
 
 namespace mdo {
 
+class ThreadData;
+
+namespace details {
+
+//
+// arguments of the emits which are not delivered yet to a coalesced or a
+// batched connection
+//
+template <typename... Args>
+class PendingEmits {
+ public:
+  using Batch = std::vector<std::tuple<std::decay_t<Args>...>>;
+
+  //
+  // returns true if there were no pending emits, i.e. the caller must post
+  // a message which takes them
+  //
+  template <typename... CallArgs>
+  bool Push(DeliveryMode mode, CallArgs&&... args) {
+    std::scoped_lock _{mutex_};
+    const auto was_empty = emits_.empty();
+
+    if (mode == DeliveryMode::kCoalesced) {
+      emits_.clear();
+    }
+
+    emits_.emplace_back(std::forward<CallArgs>(args)...);
+
+    return was_empty;
+  }
+
+  Batch Take() {
+    std::scoped_lock _{mutex_};
+    return std::exchange(emits_, {});
+  }
+
+ private:
+  std::mutex mutex_;
+  Batch emits_;
+};
+
+//
+// A connection of a signal to a slot.
+//
+// The direct call goes through a plain function pointer instantiated for the
+// receiver type, the method pointer is stored without its type. The thread
+// affinity of the receiver is cached, so the emit takes no locks to choose
+// between the direct call and the posting of the emit.
+//
+template <typename... Args>
+struct SlotConnection {
+  using Thunk = void (*)(const SlotConnection& connection, Args... args);
+
+  static constexpr size_t kMaxMethodSize = 4 * sizeof(void*);
+
+  //
+  // invalid for the function slots which are always called directly
+  //
+  ObjectHandle receiver;
+
+  std::shared_ptr<ConnectionControl> control;
+
+  //
+  // nullptr for receivers bound to a thread pool
+  //
+  std::shared_ptr<ThreadData> receiver_thread_data;
+
+  ConnectionType type = ConnectionType::kAuto;
+  Thunk direct = nullptr;
+  void* object = nullptr;
+  alignas(std::max_align_t) std::array<std::byte, kMaxMethodSize> method{};
+
+  //
+  // the function slot or the posting of the emit to the receiver's thread
+  //
+  std::function<void(Args...)> slot;
+
+  template <typename ObjectType, typename Method>
+  void SetMethod(ObjectType* receiver_object, Method receiver_method) {
+    static_assert(sizeof(Method) <= kMaxMethodSize && std::is_trivially_copyable_v<Method>,
+                  "the method pointer doesn't fit into the connection");
+
+    object = receiver_object;
+    std::memcpy(method.data(), &receiver_method, sizeof(receiver_method));
+  }
+
+  template <typename ObjectType, typename Method>
+  Method GetMethod() const noexcept {
+    Method receiver_method;
+    std::memcpy(&receiver_method, method.data(), sizeof(receiver_method));
+    return receiver_method;
+  }
+
+  void Emit(const ThreadData* current_thread_data, Args... args) const {
+    if (!control->connected.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    if (!receiver) {
+      direct(*this, std::forward<Args>(args)...);
+      return;
+    }
+
+    const auto same_thread = receiver_thread_data && receiver_thread_data.get() == current_thread_data;
+
+    if (type == ConnectionType::kQueued || (type == ConnectionType::kAuto && !same_thread)) {
+      slot(std::forward<Args>(args)...);
+      return;
+    }
+
+    const ObjectPin pin{receiver};
+
+    if (pin) {
+      direct(*this, std::forward<Args>(args)...);
+    } else {
+      Disconnect();
+    }
+  }
+
+  //
+  // the connection of a dead receiver is dropped by the next update of the
+  // signal's connections
+  //
+  void Disconnect() const noexcept { control->connected.store(false, std::memory_order_relaxed); }
+};
+
+//
+// Copy-on-write list of the connections of a signal.
+//
+// An emit reads the current snapshot of the list without locking and
+// without writing any shared memory (see EmitEpochs). Connecting and
+// disconnecting copy the list under the mutex and publish the copy. A
+// replaced snapshot is retired and deleted by the update or the emit which
+// finds that no emit can read it anymore.
+//
+template <typename... Args>
+class SlotList {
+ public:
+  using Connections = std::vector<SlotConnection<Args...>>;
+
+  //
+  // the move-only arguments of an emit can be given to one slot only, so
+  // such a signal accepts one connection
+  //
+  static constexpr bool kCopyableArgs = (std::is_copy_constructible_v<std::decay_t<Args>> && ...);
+
+  SlotList()
+      : snapshot_{new Connections{}},
+        has_retired_{} {}
+
+  SlotList(const SlotList& other) = delete;
+  SlotList& operator=(const SlotList& other) = delete;
+
+  ~SlotList() { delete snapshot_.load(); }
+
+  template <typename... CallArgs>
+  void Emit(CallArgs&&... args) {
+    const auto current_thread_data = Utils::CurrentThreadData();
+
+    EmitEpochs::Enter();
+
+    struct ReadGuard {
+      ~ReadGuard() {
+        EmitEpochs::Leave();
+
+        //
+        // the emit may be the last one which could read the retired
+        // snapshots, so nothing waits for the next update to delete them
+        //
+        if (list.has_retired_.load(std::memory_order_relaxed)) {
+          list.Reclaim();
+        }
+      }
+
+      SlotList& list;
+    } _{*this};
+
+    const auto& connections = *snapshot_.load();
+
+    if constexpr (kCopyableArgs) {
+      //
+      // each connection but the last one gets a copy of the arguments, the
+      // last one takes the rvalue arguments of the emit
+      //
+      for (size_t i = 0; i + 1 < connections.size(); ++i) {
+        connections[i].Emit(current_thread_data, args...);
+      }
+
+      if (!connections.empty()) {
+        connections.back().Emit(current_thread_data, std::forward<CallArgs>(args)...);
+      }
+    } else {
+      //
+      // the snapshot may still hold a disconnected connection next to the
+      // one that replaced it, only the connected one gets the arguments
+      //
+      for (const auto& connection : connections) {
+        if (connection.control->IsConnected()) {
+          connection.Emit(current_thread_data, std::forward<CallArgs>(args)...);
+          break;
+        }
+      }
+    }
+  }
+
+  Connection Add(SlotConnection<Args...>&& connection) {
+    connection.control = std::make_shared<ConnectionControl>(connection.receiver);
+    Connection result{connection.control};
+    auto added = true;
+
+    Update([&connection, &added](Connections& connections) {
+      if (!kCopyableArgs && !connections.empty()) {
+        added = false;
+        return;
+      }
+
+      connections.push_back(std::move(connection));
+    });
+
+    if (!added) {
+      LOG_ERROR("the signal with move-only arguments is already connected, the connection is rejected");
+      return {};
+    }
+
+    return result;
+  }
+
+  void Clear() {
+    Update([](Connections& connections) {
+      for (const auto& connection : connections) {
+        connection.Disconnect();
+      }
+
+      connections.clear();
+    });
+  }
+
+ private:
+  //
+  // the disconnected connections and the connections of dead receivers are
+  // not copied to the new snapshot
+  //
+  template <typename Change>
+  void Update(Change&& change) {
+    std::vector<std::unique_ptr<Connections>> reclaimed;
+    std::scoped_lock _{mutex_};
+
+    auto connections = std::make_unique<Connections>();
+
+    for (const auto& connection : *snapshot_.load(std::memory_order_relaxed)) {
+      if (connection.control->IsConnected()) {
+        connections->push_back(connection);
+      }
+    }
+
+    change(*connections);
+
+    //
+    // nothing throws after the exchange, otherwise the replaced snapshot
+    // could be deleted while the emits read it
+    //
+    retired_.reserve(retired_.size() + 1);
+
+    std::unique_ptr<Connections> replaced{snapshot_.exchange(connections.release())};
+    retired_.push_back({EmitEpochs::Retire(), std::move(replaced)});
+
+    reclaimed = TakeReclaimable();
+  }
+
+  //
+  // an update in progress reclaims the snapshots itself, so the emit doesn't
+  // wait for it
+  //
+  void Reclaim() {
+    std::vector<std::unique_ptr<Connections>> reclaimed;
+    std::unique_lock lock{mutex_, std::try_to_lock};
+
+    if (lock) {
+      reclaimed = TakeReclaimable();
+    }
+  }
+
+  //
+  // the callers declare the vector before locking, so the snapshots are
+  // deleted after unlocking the mutex, as the destroyed slots may emit the
+  // signal
+  //
+  std::vector<std::unique_ptr<Connections>> TakeReclaimable() {
+    const auto oldest_active = EmitEpochs::OldestActive();
+    std::vector<std::unique_ptr<Connections>> reclaimable;
+
+    for (auto& retired : retired_) {
+      if (retired.epoch < oldest_active) {
+        reclaimable.push_back(std::move(retired.connections));
+      }
+    }
+
+    std::erase_if(retired_, [](const auto& retired) { return !retired.connections; });
+    has_retired_.store(!retired_.empty(), std::memory_order_relaxed);
+
+    return reclaimable;
+  }
+
+ private:
+  struct Retired {
+    uint64_t epoch;
+    std::unique_ptr<Connections> connections;
+  };
+
+  std::mutex mutex_;
+  std::atomic<Connections*> snapshot_;
+  std::atomic_bool has_retired_;
+  std::vector<Retired> retired_;
+};
+
+}// namespace details
+
 template <typename... Args>
 class Signal final {
  public:
@@ -16,51 +337,168 @@ class Signal final {
   template <typename ObjectType>
   using MethodSlot = void (ObjectType::*)(Args...);
 
+  //!
+  //! Arguments of the emits delivered to a batched connection in one call.
+  //!
+  using Batch = typename details::PendingEmits<Args...>::Batch;
+
+  template <typename ObjectType>
+  using BatchSlot = void (ObjectType::*)(Batch&);
+
   using Slot = std::function<void(Args...)>;
 
-  explicit Signal(NotNull<Object*> owner) : owner_{owner} {}
+  explicit Signal(NotNull<Object*> owner) : owner_{owner->Handle()} {}
 
+  //!
+  //! Calls the connected slots. The connections may be changed by other
+  //! threads meanwhile, the emit uses the connections that existed when it
+  //! started.
+  //!
+  //! The arguments are copied once per connection and moved into the posted
+  //! messages, the rvalue arguments are moved into the last connection. Wrap
+  //! large payloads into SharedBuffer or std::shared_ptr<const T> to share
+  //! them between the receivers without copying.
+  //!
+  //! A signal with move-only arguments (e.g. std::unique_ptr) can have one
+  //! connection only, as the arguments can't be given to more than one slot.
+  //! Connecting it again while the connection exists fails, the returned
+  //! Connection isn't connected.
+  //!
   template <typename... CallArgs>
   void operator()(CallArgs&&... args) {
-    for (const auto& slot : slots_) {
-      slot(std::forward<CallArgs>(args)...);
-    }
+    slots_.Emit(std::forward<CallArgs>(args)...);
   }
 
+  //!
+  //! Connects the method slot of the object. The mode defines how the emits
+  //! are delivered if they are posted to the object's thread, a batched
+  //! connection calls the slot for each of the accumulated emits.
+  //!
   template <typename ObjectType>
-  void Connect(ObjectType* object, MethodSlot<ObjectType> slot) {
-    static_assert(std::is_base_of_v<Object, ObjectType>,
-                  "ObjectType must be derived from class Object");
+  Connection Connect(
+    ObjectType* object,
+    MethodSlot<ObjectType> slot,
+    ConnectionType type = ConnectionType::kAuto,
+    DeliveryMode mode = DeliveryMode::kQueued) {
+    auto connection = MakeConnection(object, slot, type);
 
-    Slot wrapper = [=, this](Args&&... args) {
-      if (!Utils::IsThreadRunning(object->Thread())) {
-        LOG_WARNING(
-          "signal receiver object's thread has not yet been started "
-          "so this emit would be skipped by the object");
-      }
+    connection.direct = [](const SlotConnection& connection, Args... args) {
+      const auto slot = connection.template GetMethod<ObjectType, MethodSlot<ObjectType>>();
+      std::invoke(slot, static_cast<ObjectType*>(connection.object), std::forward<Args>(args)...);
+    };
 
-      if (Utils::CurrentThread() == object->Thread()) {
-        std::invoke(slot, object, std::forward<Args>(args)...);
-      } else {
+    if (mode == DeliveryMode::kQueued) {
+      connection.slot = [object, slot, owner = owner_, receiver = connection.receiver](Args... args) {
         Dispatcher::Dispatch(InvokeSlotMessage{
-          [=]() mutable {
+          [object, slot, ... args = std::forward<Args>(args)]() mutable {
             std::invoke(slot, object, std::forward<Args>(args)...);
           },
-          owner_,
-          object});
-      }
+          owner,
+          receiver});
+      };
+    } else {
+      connection.slot = MakePendingSlot(connection.receiver, mode, [object, slot](Batch& batch) {
+        for (auto& emit : batch) {
+          std::apply([&](auto&... args) { std::invoke(slot, object, std::forward<Args>(args)...); }, emit);
+        }
+      });
+    }
+
+    return slots_.Add(std::move(connection));
+  }
+
+  template <typename ObjectType>
+  Connection Connect(ObjectType* object, MethodSlot<ObjectType> slot, DeliveryMode mode) {
+    return Connect(object, slot, ConnectionType::kAuto, mode);
+  }
+
+  //!
+  //! Connects the slot which receives all emits accumulated while the
+  //! object's thread was busy in one call (see DeliveryMode::kBatched).
+  //!
+  template <typename ObjectType>
+  Connection Connect(ObjectType* object, BatchSlot<ObjectType> slot, ConnectionType type = ConnectionType::kAuto) {
+    auto connection = MakeConnection(object, slot, type);
+
+    connection.direct = [](const SlotConnection& connection, Args... args) {
+      const auto slot = connection.template GetMethod<ObjectType, BatchSlot<ObjectType>>();
+
+      Batch batch;
+      batch.emplace_back(std::forward<Args>(args)...);
+      std::invoke(slot, static_cast<ObjectType*>(connection.object), batch);
     };
 
-    slots_.push_back(wrapper);
+    connection.slot = MakePendingSlot(connection.receiver, DeliveryMode::kBatched, [object, slot](Batch& batch) {
+      std::invoke(slot, object, batch);
+    });
+
+    return slots_.Add(std::move(connection));
+  }
+
+  Connection Connect(FunctionSlot slot) {
+    SlotConnection connection;
+    connection.slot = slot;
+    connection.direct = [](const SlotConnection& connection, Args... args) {
+      connection.slot(std::forward<Args>(args)...);
+    };
+
+    return slots_.Add(std::move(connection));
+  }
+
+  void DisconnectAll() { slots_.Clear(); }
+
+ private:
+  using SlotConnection = details::SlotConnection<Args...>;
+
+  template <typename ObjectType, typename Method>
+  static SlotConnection MakeConnection(ObjectType* object, Method method, ConnectionType type) {
+    static_assert(std::is_base_of_v<Object, ObjectType>,
+                  "ObjectType must be derived from class Object");
+
+    SlotConnection connection;
+    connection.receiver = object->Handle();
+    connection.receiver_thread_data = Utils::ThreadDataOf(object->Thread());
+    connection.type = type;
+    connection.SetMethod(object, method);
+
+    return connection;
   }
 
-  void Connect(FunctionSlot slot) { slots_.emplace_back(slot); }
+  template <typename InvokeBatch>
+  Slot MakePendingSlot(const ObjectHandle& receiver, DeliveryMode mode, InvokeBatch invoke_batch) const {
+    const auto pending = std::make_shared<details::PendingEmits<Args...>>();
+
+    return [=, owner = owner_](Args... args) {
+      //
+      // the message taking the pending emits is already queued
+      //
+      if (!pending->Push(mode, std::forward<Args>(args)...)) {
+        return;
+      }
+
+      const auto error = Dispatcher::Dispatch(InvokeSlotMessage{
+        [=] {
+          auto batch = pending->Take();
+
+          if (!batch.empty()) {
+            invoke_batch(batch);
+          }
+        },
+        owner,
+        receiver});
 
-  void DisconnectAll() noexcept { slots_.clear(); }
+      //
+      // the next emit must post the message again
+      //
+      if (error) {
+        pending->Take();
+      }
+    };
+  }
 
  private:
-  Object* owner_;
-  std::vector<Slot> slots_;
+  ObjectHandle owner_;
+  details::SlotList<Args...> slots_;
 };
 
 template <>
@@ -71,46 +509,88 @@ class Signal<void> final {
 
   using Slot = std::function<void()>;
 
-  explicit Signal(NotNull<Object*> owner) : owner_{owner} {}
+  explicit Signal(NotNull<Object*> owner) : owner_{owner->Handle()} {}
 
-  void operator()() {
-    for (const auto& slot : slots_) {
-      slot();
-    }
-  }
+  void operator()() { slots_.Emit(); }
 
+  //!
+  //! Connects the method slot of the object. The emits without arguments
+  //! carry nothing to accumulate, so a batched connection works the same way
+  //! as a coalesced one.
+  //!
   template <typename ObjectType>
-  void Connect(ObjectType* object, MethodSlot<ObjectType> slot) {
+  Connection Connect(
+    ObjectType* object,
+    MethodSlot<ObjectType> slot,
+    ConnectionType type = ConnectionType::kAuto,
+    DeliveryMode mode = DeliveryMode::kQueued) {
     static_assert(std::is_base_of_v<Object, ObjectType>,
                   "ObjectType must be derived from class Object");
 
-    Slot wrapper = [=, this]() {
-      if (!Utils::IsThreadRunning(object->Thread())) {
-        LOG_WARNING(
-          "signal receiver object's thread has not yet been started "
-          "so this emit would be skipped by the object");
-      }
+    SlotConnection connection;
+    connection.receiver = object->Handle();
+    connection.receiver_thread_data = Utils::ThreadDataOf(object->Thread());
+    connection.type = type;
+    connection.SetMethod(object, slot);
+
+    connection.direct = [](const SlotConnection& connection) {
+      const auto slot = connection.template GetMethod<ObjectType, MethodSlot<ObjectType>>();
+      std::invoke(slot, static_cast<ObjectType*>(connection.object));
+    };
+
+    const auto pending = mode != DeliveryMode::kQueued ? std::make_shared<std::atomic_bool>() : nullptr;
 
-      if (Utils::CurrentThread() == object->Thread()) {
-        std::invoke(slot, object);
-      } else {
+    connection.slot = [object, slot, pending, owner = owner_, receiver = connection.receiver] {
+      if (!pending) {
         Dispatcher::Dispatch(InvokeSlotMessage{
           [=] { std::invoke(slot, object); },
-          owner_,
-          object});
+          owner,
+          receiver});
+
+        return;
+      }
+
+      if (pending->exchange(true)) {
+        return;
+      }
+
+      const auto error = Dispatcher::Dispatch(InvokeSlotMessage{
+        [=] {
+          pending->store(false);
+          std::invoke(slot, object);
+        },
+        owner,
+        receiver});
+
+      if (error) {
+        pending->store(false);
       }
     };
 
-    slots_.push_back(wrapper);
+    return slots_.Add(std::move(connection));
+  }
+
+  template <typename ObjectType>
+  Connection Connect(ObjectType* object, MethodSlot<ObjectType> slot, DeliveryMode mode) {
+    return Connect(object, slot, ConnectionType::kAuto, mode);
   }
 
-  void Connect(Slot slot) { slots_.emplace_back(slot); }
+  Connection Connect(Slot slot) {
+    SlotConnection connection;
+    connection.slot = std::move(slot);
+    connection.direct = [](const SlotConnection& connection) { connection.slot(); };
+
+    return slots_.Add(std::move(connection));
+  }
 
-  void DisconnectAll() noexcept { slots_.clear(); }
+  void DisconnectAll() { slots_.Clear(); }
+
+ private:
+  using SlotConnection = details::SlotConnection<>;
 
  private:
-  Object* owner_;
-  std::vector<Slot> slots_;
+  ObjectHandle owner_;
+  details::SlotList<> slots_;
 };
 
 }// namespace mdo
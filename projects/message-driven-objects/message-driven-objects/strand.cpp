@@ -0,0 +1,74 @@
+#include "strand.h"
+
+#include "object.h"
+#include "objects_registry.h"
+#include "trace.h"
+
+namespace mdo {
+
+Strand::Strand() noexcept : scheduled_{} {}
+
+bool Strand::Push(Message&& message) {
+  std::scoped_lock _{mutex_};
+  messages_.push_back(std::move(message));
+
+  if (scheduled_) {
+    return false;
+  }
+
+  scheduled_ = true;
+  return true;
+}
+
+bool Strand::Run(size_t budget) {
+  std::vector<Message> messages;
+
+  {
+    std::scoped_lock _{mutex_};
+
+    const auto count = std::min(budget, messages_.size());
+    messages.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      messages.push_back(std::move(messages_.front()));
+      messages_.pop_front();
+    }
+  }
+
+  for (auto& message : messages) {
+    HandleMessage(message);
+  }
+
+  std::scoped_lock _{mutex_};
+
+  if (messages_.empty()) {
+    scheduled_ = false;
+    return false;
+  }
+
+  return true;
+}
+
+size_t Strand::Size() const noexcept {
+  std::scoped_lock _{mutex_};
+  return messages_.size();
+}
+
+void Strand::HandleMessage(Message& message) {
+  //
+  // the same protection of the receiver as in Thread::HandleMessage
+  //
+  const ObjectPin pin{std::visit(GetReceiverHandle, message)};
+  const auto receiver = pin.Get();
+
+  if (!receiver) {
+    LOG_WARNING("the receiver of the message to thread pool is dead so the message is skipped");
+    return;
+  }
+
+  MDO_TRACE_HANDLED(message);
+
+  receiver->OnMessage(message);
+}
+
+}// namespace mdo
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "message.h"
+
+namespace mdo {
+
+//!
+//! Mailbox of an Object bound to a ThreadPool.
+//!
+//! Strand serializes handling of the messages addressed to its object: the
+//! strand is scheduled to the pool at most once at any moment, so only one
+//! worker handles the object's messages and they are handled in the order
+//! they were posted, although consecutive batches can be handled by
+//! different workers.
+//!
+class Strand final {
+ public:
+  Strand() noexcept;
+
+  //!
+  //! Appends a message to the mailbox.
+  //! Returns true if the strand wasn't scheduled yet and the caller must
+  //! schedule it to the pool.
+  //!
+  bool Push(Message&& message);
+
+  //!
+  //! Handles at most 'budget' messages in the calling thread.
+  //! Returns true if the mailbox still contains messages, in this case the
+  //! strand stays in the scheduled state and the caller must reschedule it.
+  //!
+  bool Run(size_t budget);
+
+  size_t Size() const noexcept;
+
+ private:
+  static void HandleMessage(Message& message);
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<Message> messages_;
+  bool scheduled_;
+};
+
+}// namespace mdo
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Return type of the coroutine handlers.
+//!
+//! The coroutine starts executing immediately in the calling thread and runs
+//! until the first suspension point (co_await CallAsync(...), co_await
+//! Sleep(...)), then the calling handler returns and the thread continues to
+//! handle other messages. The awaitables resume the coroutine by a message to
+//! the object which handled the message at the moment of suspension, so the
+//! coroutine continues in the thread (or the strand of the thread pool) it
+//! was started in.
+//!
+//! Task is "fire and forget": the coroutine frame is destroyed when the
+//! coroutine finishes. The coroutine must not outlive the objects it uses.
+//!
+class Task final {
+ public:
+  struct promise_type {
+    Task get_return_object() noexcept { return {}; }
+
+    std::suspend_never initial_suspend() noexcept { return {}; }
+
+    std::suspend_never final_suspend() noexcept { return {}; }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept {
+      LOG_CRITICAL("unhandled exception in the coroutine");
+      std::terminate();
+    }
+  };
+};
+
+}// namespace mdo
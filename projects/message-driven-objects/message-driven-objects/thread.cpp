@@ -1,16 +1,17 @@
 #include "thread.h"
 
 #include "adopted_thread.h"
+#include "io_notifier.h"
 #include "objects_registry.h"
 #include "set_thread_name_message.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "wait_primitives.h"
 
 //
 // WARN: Проблемы
 // 1. Создание объектов выполняется в одном отдельно взятом потоке
 // 2. Разрушается объект также только в одном потоке (в каком?)
-// 3. Уничтожающийся объект может получить сообщение от другого объекта, т.к. поток продолжает свою работу
-//   и ObjectsRegistry не спасает от этого, потому, что он не дает уничтожить только самую базовую часть объекта типа Object.
-// 4. Сейчас код устроен так, что сперва нужно остановить поток, потом уже разрушать объект, приаттаченный к этому потоку. См. бенчмарки.
 //
 
 #if defined(USE_WINDOWS_SET_THREAD_NAME_HACK)
@@ -47,6 +48,16 @@ void SetThreadName(DWORD thread_id, const std::string& thread_name) {
 namespace mdo {
 
 thread_local std::shared_ptr<ThreadData> current_thread_data = nullptr;
+thread_local constinit ThreadData* current_thread_data_ptr = nullptr;
+
+namespace {
+
+void SetCurrentThreadData(std::shared_ptr<ThreadData> data) {
+  current_thread_data_ptr = data.get();
+  current_thread_data = std::move(data);
+}
+
+}// namespace
 
 const std::shared_ptr<ThreadData>&
 GetThreadData(const Thread* thread) noexcept {
@@ -54,16 +65,16 @@ GetThreadData(const Thread* thread) noexcept {
 }
 
 Thread* Thread::Current() {
-  if (current_thread_data) {
-    return current_thread_data->Thread();
+  if (current_thread_data_ptr) {
+    return current_thread_data_ptr->Thread();
   }
 
-  current_thread_data = std::make_unique<ThreadData>();
-  current_thread_data->SetId(std::this_thread::get_id());
-  current_thread_data->SetIsAdopted(true);
-  current_thread_data->SetThread(new AdoptedThread(current_thread_data));// how to delete it?
+  SetCurrentThreadData(std::make_shared<ThreadData>());
+  current_thread_data_ptr->SetId(std::this_thread::get_id());
+  current_thread_data_ptr->SetIsAdopted(true);
+  Initialize(*new AdoptedThread(current_thread_data));// how to delete it?
 
-  return current_thread_data->Thread();
+  return current_thread_data_ptr->Thread();
 }
 
 void Thread::YieldThread() { std::this_thread::yield(); }
@@ -82,6 +93,116 @@ void Thread::SetCurrentThreadName(const std::string& name) noexcept {
 #endif
 }
 
+void Thread::SetCurrentThreadTimerSlack(const std::chrono::nanoseconds& slack) noexcept {
+#if defined(__linux__)
+  prctl(PR_SET_TIMERSLACK, std::max<long>(slack.count(), 1), 0, 0, 0);
+#else
+  (void) slack;
+#endif
+}
+
+std::error_code Thread::SetCurrentThreadOptions(const ThreadOptions& options) noexcept {
+  std::error_code result;
+
+  const auto check = [&result](const char* option, const std::error_code& error) {
+    if (error) {
+      LOG_WARNING("can't set the '{}' option of the thread: {}", option, error.message());
+
+      if (!result) {
+        result = error;
+      }
+    }
+  };
+
+#if defined(__linux__)
+  if (!options.cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    const auto valid = std::all_of(options.cpus.begin(), options.cpus.end(), [](size_t cpu) { return cpu < CPU_SETSIZE; });
+
+    if (!valid) {
+      check("cpus", std::make_error_code(std::errc::invalid_argument));
+    } else {
+      for (const auto cpu : options.cpus) {
+        CPU_SET(cpu, &cpus);
+      }
+
+      check("cpus", std::error_code{pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus), std::system_category()});
+    }
+  }
+
+  if (options.numa_node) {
+    //
+    // set_mempolicy(MPOL_PREFERRED) without linking libnuma
+    //
+    constexpr int kPreferredPolicy = 1;
+    constexpr size_t kMaskBits = 8 * sizeof(unsigned long);
+
+    std::array<unsigned long, 16> mask{};
+
+    if (*options.numa_node >= mask.size() * kMaskBits) {
+      check("numa_node", std::make_error_code(std::errc::invalid_argument));
+    } else {
+      mask[*options.numa_node / kMaskBits] |= 1ul << (*options.numa_node % kMaskBits);
+
+      if (syscall(SYS_set_mempolicy, kPreferredPolicy, mask.data(), mask.size() * kMaskBits + 1) != 0) {
+        check("numa_node", std::error_code{errno, std::system_category()});
+      }
+    }
+  }
+#elif defined(_WIN32)
+  if (!options.cpus.empty()) {
+    constexpr size_t kMaskBits = 8 * sizeof(DWORD_PTR);
+
+    DWORD_PTR mask = 0;
+
+    const auto valid = std::all_of(options.cpus.begin(), options.cpus.end(), [](size_t cpu) { return cpu < kMaskBits; });
+
+    if (!valid) {
+      check("cpus", std::make_error_code(std::errc::invalid_argument));
+    } else {
+      for (const auto cpu : options.cpus) {
+        mask |= DWORD_PTR{1} << cpu;
+      }
+
+      if (!SetThreadAffinityMask(GetCurrentThread(), mask)) {
+        check("cpus", std::error_code{static_cast<int>(GetLastError()), std::system_category()});
+      }
+    }
+  }
+
+  if (options.numa_node) {
+    check("numa_node", std::make_error_code(std::errc::not_supported));
+  }
+#else
+  if (!options.cpus.empty()) {
+    check("cpus", std::make_error_code(std::errc::not_supported));
+  }
+
+  if (options.numa_node) {
+    check("numa_node", std::make_error_code(std::errc::not_supported));
+  }
+#endif
+
+  if (options.policy != SchedulingPolicy::kDefault) {
+#if defined(_WIN32)
+    if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+      check("policy", std::error_code{static_cast<int>(GetLastError()), std::system_category()});
+    }
+#else
+    sched_param param{};
+    param.sched_priority = options.priority;
+
+    const auto policy = options.policy == SchedulingPolicy::kFifo ? SCHED_FIFO : SCHED_RR;
+
+    check("policy", std::error_code{pthread_setschedparam(pthread_self(), policy, &param), std::system_category()});
+#endif
+  }
+
+  return result;
+}
+
 std::unique_ptr<Thread> Thread::Create(const char* name) {
   struct NewEnabler : Thread {
     explicit NewEnabler(std::function<void()> alternative_entry_point)
@@ -105,6 +226,8 @@ Thread::~Thread() {
 
   LOG_INFO("thread '{}' destroyed", thread_name);
 
+  data_->Queue().SetWatermarkHandlers(nullptr, nullptr);
+
   data_->SetThread(nullptr);
 }
 
@@ -112,6 +235,7 @@ const std::string& Thread::Name() const noexcept { return name_; }
 
 void Thread::SetName(const std::string& name) {
   name_ = name;
+  data_->SetName(name);
 
   if (data_->IsAdopted()) {
     SetCurrentThreadName(name_);
@@ -121,58 +245,95 @@ void Thread::SetName(const std::string& name) {
 }
 
 void Thread::Start() {
-  if (future_.valid()) {
-    LOG_WARNING("attempt to start already started thread");
-    return;
-  }
+  auto expected = state_.load(std::memory_order_acquire);
 
-  future_ = std::async(std::launch::async, [this] {
-    SetCurrentThreadName(name_);
-    current_thread_data = data_;
-    current_thread_data->SetId(std::this_thread::get_id());
+  do {
+    if (expected != ThreadState::kCreated && expected != ThreadState::kStopped) {
+      LOG_WARNING("attempt to start already started thread");
+      return;
+    }
+  } while (!state_.compare_exchange_weak(expected, ThreadState::kStarting, std::memory_order_acq_rel));
 
-    LOG_TRACE("starting '{}' thread", CurrentThreadId());
+  {
+    //
+    // the previous run of the thread has returned, so the join doesn't block
+    //
+    const std::scoped_lock _{join_mutex_};
 
-    if (alternative_entry_point_) {
-      alternative_entry_point_();
-    } else {
-      Run();
+    if (thread_.joinable()) {
+      thread_.join();
     }
-  });
+
+    //
+    // the flags are reset here rather than in Run(), otherwise a Stop()
+    // called before the new thread reaches Run() would be lost
+    //
+    data_->SetInterruptionRequest(false);
+    data_->Queue().SetInterruptFlag(false);
+    data_->Queue().SetClosed(false);
+
+    thread_ = std::jthread{[this](std::stop_token stop_token) {
+      SetCurrentThreadName(name_);
+      SetCurrentThreadData(data_);
+      current_thread_data_ptr->SetId(std::this_thread::get_id());
+
+      //
+      // the stop request wakes the event loop up like the interruption does
+      //
+      const std::stop_callback on_stop{stop_token, [data = data_] {
+                                         data->SetInterruptionRequest();
+                                         data->Queue().SetInterruptFlag(true);
+                                       }};
+
+      LOG_TRACE("starting '{}' thread", CurrentThreadId());
+
+      if (alternative_entry_point_) {
+        MarkRunning();
+        alternative_entry_point_();
+      } else {
+        Run();
+      }
+
+      SetState(ThreadState::kStopped);
+    }};
+  }
 }
 
 void Thread::Wait() const noexcept {
-  if (!future_.valid()) {
+  if (IsCurrentThread()) {
     return;
   }
 
-  future_.wait();
+  std::unique_lock lock{state_mutex_};
+
+  state_changed_.wait(lock, [this] {
+    const auto state = state_.load(std::memory_order_acquire);
+    return state == ThreadState::kCreated || state == ThreadState::kStopped;
+  });
 }
 
 bool Thread::WaitFor(const std::chrono::milliseconds& ms) const noexcept {
-  if (!future_.valid()) {
-    return true;
-  }
-
-  const auto await_result = future_.wait_for(ms);
-
-  if (await_result == std::future_status::deferred) {
-    LOG_CRITICAL("the thread function must not be in a deferred state");
-    std::terminate();
-  }
-
-  if (await_result == std::future_status::timeout) {
+  if (IsCurrentThread()) {
     return false;
   }
 
-  return true;
+  std::unique_lock lock{state_mutex_};
+
+  return state_changed_.wait_for(lock, ms, [this] {
+    const auto state = state_.load(std::memory_order_acquire);
+    return state == ThreadState::kCreated || state == ThreadState::kStopped;
+  });
 }
 
 void Thread::Stop() { StopImpl(); }
 
 bool Thread::IsRunning() const noexcept {
-  return future_.valid() &&
-         future_.wait_for(0s) == std::future_status::timeout;
+  const auto state = state_.load(std::memory_order_acquire);
+  return state != ThreadState::kCreated && state != ThreadState::kStopped;
+}
+
+ThreadState Thread::State() const noexcept {
+  return state_.load(std::memory_order_acquire);
 }
 
 void Thread::RequestInterruption() const noexcept {
@@ -183,110 +344,200 @@ bool Thread::IsInterruptionRequested() const noexcept {
   return data_->InterruptionRequested();
 }
 
+void Thread::SetQueueLimits(const QueueLimits& limits) {
+  data_->Queue().SetLimits(limits);
+}
+
+void Thread::SetWaitOptions(const WaitOptions& options) {
+  data_->SetWaitOptions(options);
+}
+
+void Thread::SetOptions(const ThreadOptions& options) {
+  data_->SetOptions(options);
+}
+
+ThreadOptions Thread::Options() const { return data_->Options(); }
+
+ThreadMetricsSnapshot Thread::Metrics() const { return data_->MetricsSnapshot(); }
+
+size_t Thread::DroppedOnStop() const noexcept {
+  return dropped_on_stop_.load(std::memory_order_acquire);
+}
+
 void Thread::Run() {
-  current_thread_data->SetInterruptionRequest(false);
-  current_thread_data->Queue().SetInterruptFlag(false);
+  if (current_thread_data_ptr->IsAdopted()) {
+    current_thread_data_ptr->SetInterruptionRequest(false);
+    current_thread_data_ptr->Queue().SetInterruptFlag(false);
+    current_thread_data_ptr->Queue().SetClosed(false);
+  }
+
+  MarkRunning();
 
   const auto tid = Thread::CurrentThreadId();
 
+  //
+  // the thread is placed before emitting 'Started', so the handlers of the
+  // signal already run on the thread's CPUs
+  //
+  const auto options = current_thread_data_ptr->Options();
+  const auto& wait_options = options.wait;
+
+  SetCurrentThreadOptions(options);
+
   //
   // emit 'Started' signal
   //
-  {
-    std::scoped_lock _{ObjectsRegistry::Instance()};
-    Started();
-  }
+  Started();
 
   LOG_TRACE(
     "the '{}' thread started, current queue '{}' contains '{}' "
     "pending messages",
     tid,
-    (void*) &current_thread_data->Queue(),
-    current_thread_data->Queue().Size());
+    (void*) &current_thread_data_ptr->Queue(),
+    current_thread_data_ptr->Queue().Size());
 
-  while (!current_thread_data->InterruptionRequested()) {
+  auto& queue = current_thread_data_ptr->Queue();
+  auto& timers = current_thread_data_ptr->Timers();
+
+  //
+  // with the io option the loop sleeps in epoll_wait() and the queue wakes
+  // it up through the eventfd of the poller
+  //
+  auto poller = options.io ? &current_thread_data_ptr->Poller() : nullptr;
+  std::vector<details::IoPoller::Event> io_events;
+
+  if (poller) {
+    queue.SetWakeupHandler([poller] { poller->Wakeup(); });
+  }
+
+  queue.SetWaitOptions(wait_options);
+
+  if (wait_options.strategy != WaitStrategy::kSleep) {
+    SetCurrentThreadTimerSlack(1ns);
+  }
+
+  while (!current_thread_data_ptr->InterruptionRequested()) {
     std::vector<Message> messages;
-    const auto error = current_thread_data->Queue().Poll(messages, 1s);
 
-    LOG_TRACE("the '{}' thread is reading from '{}' queue", tid, (void*) &current_thread_data->Queue());
+    //
+    // the thread sleeps until the nearest deadline of its local timers
+    //
+    auto timeout = timers.Timeout(MessageQueue::kInfiniteTimeout);
+
+    if (wait_options.strategy == WaitStrategy::kBusyPoll) {
+      timeout = 0ns;
+    } else if (wait_options.strategy == WaitStrategy::kHybrid && timeout != MessageQueue::kInfiniteTimeout) {
+      timeout = std::max<std::chrono::nanoseconds>(timeout - wait_options.spin_threshold, 0ns);
+    }
+
+    if (poller && !PollIo(*poller, timeout, io_events)) {
+      LOG_ERROR("the '{}' thread can't wait for the descriptors and waits for the messages only", tid);
+
+      queue.SetWakeupHandler(nullptr);
+      poller = nullptr;
+    }
+
+    //
+    // the poller has already waited, so the queue is only checked
+    //
+    const auto error = queue.Poll(messages, poller ? 0ns : timeout);
+
+    LOG_TRACE("the '{}' thread is reading from '{}' queue", tid, (void*) &queue);
 
     if (error == std::errc::interrupted) {
       LOG_TRACE("the '{}' thread is interrupted", tid);
       break;
     }
 
-    if (error == std::errc::timed_out) {
+    timers.Expire(messages);
+
+    if (messages.empty()) {
       LOG_TRACE("the '{}' thread has no messages", tid);
+
+      if (timeout == 0ns && io_events.empty()) {
+        details::CpuRelax();
+      }
+
       continue;
     }
 
-    if (!messages.empty()) {
-      LOG_TRACE("the '{}' thread got the '{}' messages to process", tid, messages.size());
-    }
+    LOG_TRACE("the '{}' thread got the '{}' messages to process", tid, messages.size());
 
     HandleMessages(messages);
   }
 
-  //
-  // TODO: what if some object still lives and sends to us a messages?
-  // we need here block incoming messages but should continue handle that
-  // already received
-  //
-  /*current_thread_data->Queue().SetInterruptFlag(false);
-    std::error_code ec;
+  if (poller) {
+    queue.SetWakeupHandler(nullptr);
+  }
 
-    do {
-      std::deque<Message> messages;
-      ec = current_thread_data->Queue().Poll(messages, 1s);
-      HandleMessages(messages);
-    } while (ec != std::errc::timed_out);*/
+  if (options.stop_mode == StopMode::kDrain) {
+    Drain(options.drain_timeout);
+  }
 
   //
   // emit 'Finished' signal
   //
-  {
-    std::scoped_lock _{ObjectsRegistry::Instance()};
-    Finished();
-  }
+  Finished();
 
   LOG_TRACE("the '{}' thread finished", tid);
 }
 
 void Thread::HandleMessage(Message&& message) {
-  const auto this_thread = current_thread_data->Thread();
-  const auto receiver = std::visit(GetReceiver, message);
+  const auto this_thread = current_thread_data_ptr->Thread();
+
+  //
+  // the pin ensures that the receiver is alive and won't be retired until the
+  // message is handled, the check takes no locks (see ObjectsRegistry)
+  //
+  const ObjectPin pin{std::visit(GetReceiverHandle, message)};
+  const auto receiver = pin.Get();
+
+  if (!receiver) {
+    LOG_WARNING(
+      "the receiver of the message to thread {} is dead so the "
+      "message is skipped",
+      ToString(current_thread_data_ptr->Id()));
+
+    return;
+  }
+
+  if (const auto pool = receiver->Pool()) {
+    if (const auto error = pool->Post(std::move(message))) {
+      LOG_WARNING("the message for the thread pool is lost: {}", error.message());
+    }
+
+    return;
+  }
+
   const auto receiver_thread = receiver->Thread();
 
   if (this_thread == receiver_thread) {
     LOG_TRACE("the thread '{}' received and handling a message",
               this_thread->Name());
 
-    //
-    // block ability to destroy an Object class objects
-    // to be sure that we can safely call
-    // message->Receiver()->OnMessage(message);
-    //
-    // It ensures that receiver object is alive or already dead (doesn't exists) but not in destroy state!
-    // Each object in dtor removes itself from ObjectsRegistry.
-    //
-    // WARN: this approach is invalid!
-    // Because the Object type usually just a first subobject of the real object!
-    // So when actual object start calling his dtor, that part of the overall object already dead.
-    // Need to reconsider the approach to sending messages to dying objects!
-    //
-    std::scoped_lock _{ObjectsRegistry::Instance()};
+    MDO_TRACE_HANDLED(message);
 
-    if (!ObjectsRegistry::Instance().HasObject(receiver)) {
-      LOG_WARNING(
-        "the object {} that lived in thread {} is dead so the "
-        "message to it is skipped",
-        static_cast<void*>(receiver),
-        ToString(current_thread_data->Id()));
+    auto& metrics = current_thread_data_ptr->Metrics();
 
+    if (!mdo::Metrics::TimingsEnabled()) {
+      receiver->OnMessage(message);
+      metrics.OnHandled();
       return;
     }
 
+    //
+    // the handler can delete the receiver, so its type is taken beforehand
+    //
+    const auto& type = typeid(*receiver);
+    const auto posted_at = std::visit(GetPostedAt, message);
+    const auto started_at = std::chrono::steady_clock::now();
+
+    if (posted_at != std::chrono::steady_clock::time_point{}) {
+      metrics.OnLatency(started_at - posted_at);
+    }
+
     receiver->OnMessage(message);
+    metrics.OnHandled(type, std::chrono::steady_clock::now() - started_at);
   } else {
     LOG_TRACE(
       "the thread '{}' received a message for the '{}' thread, "
@@ -294,10 +545,53 @@ void Thread::HandleMessage(Message&& message) {
       this_thread->Name(),
       receiver_thread->Name());
 
-    GetThreadData(receiver_thread)->Queue().Post(std::move(message));
+    if (const auto error = GetThreadData(receiver_thread)->Queue().Post(std::move(message))) {
+      LOG_WARNING(
+        "the message for the '{}' thread is lost: {}",
+        receiver_thread->Name(),
+        error.message());
+    }
   }
 }
 
+bool Thread::PollIo(details::IoPoller& poller,
+                    const std::chrono::nanoseconds& timeout,
+                    std::vector<details::IoPoller::Event>& events) {
+  auto& queue = current_thread_data_ptr->Queue();
+
+  //
+  // the loop doesn't sleep if a message was posted after the previous poll
+  //
+  const auto wait = timeout != 0ns && queue.PrepareExternalWait();
+
+  events.clear();
+
+  const auto error = poller.Wait(wait ? timeout : 0ns, events);
+
+  if (wait) {
+    queue.FinishExternalWait();
+  }
+
+  if (error) {
+    LOG_ERROR("failed to wait for the descriptors: {}", error.message());
+    return false;
+  }
+
+  for (const auto& event : events) {
+    //
+    // only IoNotifiers register the descriptors, the pin skips the events of
+    // the destroyed ones
+    //
+    const ObjectPin pin{event.notifier};
+
+    if (const auto notifier = static_cast<IoNotifier*>(pin.Get())) {
+      notifier->Activate(event.events);
+    }
+  }
+
+  return true;
+}
+
 void Thread::HandleMessages(std::vector<Message>& messages) {
   for (auto& message : messages) {
     if (std::holds_alternative<SetThreadNameMessage>(message)) {
@@ -318,8 +612,8 @@ std::string Thread::CurrentThreadId() {
   // 2. each evaluation of current_thread_data should compare its value with
   // nullptr
   //
-  const auto id = ToString(current_thread_data->Id());
-  const auto& thread_name = current_thread_data->Thread()->Name();
+  const auto id = ToString(current_thread_data_ptr->Id());
+  const auto& thread_name = current_thread_data_ptr->Thread()->Name();
 
   if (thread_name.empty()) {
     return ToString(id);
@@ -334,7 +628,7 @@ Thread::Thread(std::shared_ptr<ThreadData> data)
 void Thread::StopImpl() {
   const auto is_adopted = data_->IsAdopted();
 
-  if (!is_adopted && !future_.valid()) {
+  if (!is_adopted && !thread_.joinable()) {
     return;
   }
 
@@ -344,36 +638,119 @@ void Thread::StopImpl() {
     tid = name_ + "/" + tid;
   }
 
-  if (IsInterruptionRequested()) {
-    LOG_INFO("the '{}' thread is already in stopping process", tid);
-    return;
-  }
+  auto state = state_.load(std::memory_order_acquire);
 
-  RequestInterruption();
-  data_->Queue().SetInterruptFlag(true);
+  while ((state == ThreadState::kStarting || state == ThreadState::kRunning) &&
+         !state_.compare_exchange_weak(state, ThreadState::kStopping, std::memory_order_acq_rel)) {}
 
-  if (!is_adopted) {
-    while (future_.wait_for(1s) == std::future_status::timeout) {
-      LOG_TRACE("waiting for '{}' thread to stop", tid);
+  if (is_adopted) {
+    if (IsInterruptionRequested()) {
+      LOG_INFO("the '{}' thread is already in stopping process", tid);
+      return;
     }
 
-    future_.get();
-  } else {
+    RequestInterruption();
+    data_->Queue().SetInterruptFlag(true);
     Wait();
+
+    LOG_TRACE("the '{}' thread has stopped", tid);
+    return;
+  }
+
+  thread_.request_stop();
+
+  //
+  // the thread can't join itself, it finishes once the handler returns
+  //
+  if (IsCurrentThread()) {
+    LOG_TRACE("the '{}' thread is requested to stop from itself", tid);
+    return;
+  }
+
+  while (!WaitFor(1s)) {
+    LOG_TRACE("waiting for '{}' thread to stop", tid);
+  }
+
+  const std::scoped_lock _{join_mutex_};
+
+  if (thread_.joinable()) {
+    thread_.join();
   }
 
   LOG_TRACE("the '{}' thread has stopped", tid);
 }
 
+void Thread::Drain(const std::chrono::milliseconds& timeout) {
+  auto& queue = current_thread_data_ptr->Queue();
+  const auto tid = Thread::CurrentThreadId();
+
+  //
+  // the objects which still live keep posting to us, so the queue is closed
+  // before draining, otherwise it could never become empty; the interruption
+  // is lifted to let the queue be polled
+  //
+  queue.SetClosed(true);
+  queue.SetInterruptFlag(false);
+
+  LOG_TRACE("the '{}' thread is draining '{}' pending messages", tid, queue.Size());
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::vector<Message> messages;
+
+  while (std::chrono::steady_clock::now() < deadline && !queue.Poll(messages)) {
+    HandleMessages(messages);
+  }
+
+  const auto dropped = queue.Size();
+
+  queue.Clear();
+  dropped_on_stop_.store(dropped, std::memory_order_release);
+
+  if (dropped) {
+    LOG_WARNING("the '{}' thread dropped '{}' pending messages on stop", tid, dropped);
+  }
+}
+
 Thread::Thread(std::function<void()> alternative_entry_point,
                std::shared_ptr<ThreadData> data)
     : Finished{this},
       Started{this},
+      QueueHighWatermarkReached{this},
+      QueueLowWatermarkReached{this},
       data_{std::move(data)},
+      state_{ThreadState::kCreated},
+      dropped_on_stop_{},
       alternative_entry_point_{std::move(alternative_entry_point)} {
   if (!data_) {
     data_ = std::make_shared<ThreadData>();
   }
+
+  data_->Queue().SetWatermarkHandlers(
+    [this](size_t size) { QueueHighWatermarkReached(size); },
+    [this](size_t size) { QueueLowWatermarkReached(size); });
+}
+
+void Thread::SetState(ThreadState state) {
+  {
+    const std::scoped_lock _{state_mutex_};
+    state_.store(state, std::memory_order_release);
+  }
+
+  state_changed_.notify_all();
+}
+
+void Thread::MarkRunning() noexcept {
+  auto state = state_.load(std::memory_order_acquire);
+
+  //
+  // a Stop() which came while the thread was starting must not be overwritten
+  //
+  while (state != ThreadState::kStopping &&
+         !state_.compare_exchange_weak(state, ThreadState::kRunning, std::memory_order_acq_rel)) {}
+}
+
+bool Thread::IsCurrentThread() const noexcept {
+  return current_thread_data_ptr == data_.get();
 }
 
 void Thread::Initialize(Thread& thread) {
@@ -14,6 +14,27 @@ namespace mdo {
 //!
 extern thread_local std::shared_ptr<ThreadData> current_thread_data;
 
+//!
+//! WARN: internal too, the raw pointer to the current_thread_data. Unlike
+//! the shared_ptr, the variable has a constant initializer and a trivial
+//! destructor, so it's accessed without a call to the TLS wrapper function
+//! and the initialization guard.
+//!
+extern thread_local constinit ThreadData* current_thread_data_ptr;
+
+//!
+//! The lifecycle of a Thread. A thread goes from kCreated through kStarting
+//! (the OS thread is being launched) to kRunning and, once Stop() is called,
+//! through kStopping to kStopped. A stopped thread can be started again.
+//!
+enum class ThreadState : uint8_t {
+  kCreated,
+  kStarting,
+  kRunning,
+  kStopping,
+  kStopped,
+};
+
 class Thread : public Object {
  public:
   friend const std::shared_ptr<ThreadData>&
@@ -32,6 +53,20 @@ class Thread : public Object {
   //!
   Signal<void> Started;
 
+  //!
+  //! This signal is emitted when the number of pending messages in the
+  //! thread's queue reaches the high watermark set by SetQueueLimits().
+  //! It is emitted from the thread which posted the message, so producers
+  //! can connect to it to throttle themselves.
+  //!
+  Signal<size_t> QueueHighWatermarkReached;
+
+  //!
+  //! This signal is emitted from the associated thread when the number of
+  //! pending messages drops to the low watermark after reaching the high one.
+  //!
+  Signal<size_t> QueueLowWatermarkReached;
+
   //!
   //! Returns a pointer to a Thread which manages the currently executing
   //! thread.
@@ -54,6 +89,21 @@ class Thread : public Object {
   //!
   static void SetCurrentThreadName(const std::string& name) noexcept;
 
+  //!
+  //! Sets the time the OS may delay the wakeups of the currently executing
+  //! thread to coalesce them with other wakeups (50 us by default on Linux).
+  //! Does nothing on other platforms.
+  //!
+  static void SetCurrentThreadTimerSlack(const std::chrono::nanoseconds& slack) noexcept;
+
+  //!
+  //! Applies the CPU affinity, the NUMA node and the scheduling policy of the
+  //! options to the currently executing thread. The options which can't be
+  //! applied (e.g. the real-time policy without the privileges) are logged
+  //! and skipped, the first error is returned.
+  //!
+  static std::error_code SetCurrentThreadOptions(const ThreadOptions& options) noexcept;
+
   //!
   //! Creates a new Thread object that will execute the function f with the
   //! arguments args. The new thread is not started – it must be started by an
@@ -128,11 +178,20 @@ class Thread : public Object {
 
   //!
   //! Returns true if the thread is running; otherwise returns false.
+  //! The thread is considered running from Start() until its function
+  //! returns, including the time it is being stopped.
   //!
-  //! Note: This function is thread-safe.
+  //! Note: This function is thread-safe and lock-free.
   //!
   bool IsRunning() const noexcept;
 
+  //!
+  //! Returns the lifecycle state of the thread.
+  //!
+  //! Note: This function is thread-safe and lock-free.
+  //!
+  [[nodiscard]] ThreadState State() const noexcept;
+
   //!
   //! Request the interruption of the thread.
   //! That request is advisory and it is up to code running on the thread to
@@ -154,27 +213,89 @@ class Thread : public Object {
   //!
   bool IsInterruptionRequested() const noexcept;
 
+  //!
+  //! Sets the capacity, the overflow policy and the watermarks of the
+  //! thread's message queue. By default the queue is unbounded.
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  void SetQueueLimits(const QueueLimits& limits);
+
+  //!
+  //! Sets how the thread's event loop waits for messages and local timers.
+  //! The options are applied when the event loop starts, so the function
+  //! should be called before Start() (or Dispatcher::Exec() for the main
+  //! thread).
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  void SetWaitOptions(const WaitOptions& options);
+
+  //!
+  //! Sets the placement, the scheduling and the wait options of the thread.
+  //! The options are applied when the event loop starts, see SetWaitOptions.
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  void SetOptions(const ThreadOptions& options);
+
+  [[nodiscard]] ThreadOptions Options() const;
+
+  //!
+  //! Returns the number of pending messages dropped by the last stop in the
+  //! StopMode::kDrain mode because the drain timeout expired.
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  [[nodiscard]] size_t DroppedOnStop() const noexcept;
+
+  //!
+  //! Returns the snapshot of the runtime metrics of the thread, see Metrics.
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  [[nodiscard]] ThreadMetricsSnapshot Metrics() const;
+
  protected:
   void Run();
 
   void HandleMessage(Message&& message);
   void HandleMessages(std::vector<Message>& messages);
 
+  //
+  // waits for the messages and the descriptors in the poller and emits the
+  // readiness of the descriptors, returns false if the poller doesn't work
+  //
+  bool PollIo(details::IoPoller& poller,
+              const std::chrono::nanoseconds& timeout,
+              std::vector<details::IoPoller::Event>& events);
+
   static std::string CurrentThreadId();
 
+  void SetState(ThreadState state);
+
   explicit Thread(std::shared_ptr<ThreadData> data = nullptr);
 
  private:
   void StopImpl();
+  void Drain(const std::chrono::milliseconds& timeout);
 
   explicit Thread(std::function<void()> alternative_entry_point,
                   std::shared_ptr<ThreadData> data = nullptr);
 
   static void Initialize(Thread& thread);
 
+  void MarkRunning() noexcept;
+  bool IsCurrentThread() const noexcept;
+
  private:
   std::shared_ptr<ThreadData> data_;
-  std::future<void> future_;
+  std::jthread thread_;
+  std::mutex join_mutex_;
+  std::atomic<ThreadState> state_;
+  mutable std::mutex state_mutex_;
+  mutable std::condition_variable state_changed_;
+  std::atomic_size_t dropped_on_stop_;
   std::string name_;
   std::function<void()> alternative_entry_point_;
 };
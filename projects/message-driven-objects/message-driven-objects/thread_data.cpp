@@ -5,11 +5,37 @@
 
 namespace mdo {
 
+namespace {
+
+//
+// all existing thread data for collecting the metrics
+//
+std::mutex all_thread_data_mutex;
+std::vector<const ThreadData*> all_thread_data;
+
+}// namespace
+
 ThreadData::ThreadData()
     : id_{std::this_thread::get_id()},
       thread_{},
       interruption_requested_{false},
-      is_adopted_{false} {}
+      is_adopted_{false} {
+  std::scoped_lock _{all_thread_data_mutex};
+  all_thread_data.push_back(this);
+}
+
+ThreadData::~ThreadData() {
+  std::scoped_lock _{all_thread_data_mutex};
+  std::erase(all_thread_data, this);
+}
+
+void ThreadData::ForEach(const std::function<void(const ThreadData&)>& f) {
+  std::scoped_lock _{all_thread_data_mutex};
+
+  for (const auto data : all_thread_data) {
+    f(*data);
+  }
+}
 
 void ThreadData::lock() const { mutex_.lock(); }
 
@@ -19,44 +45,87 @@ MessageQueue& ThreadData::Queue() noexcept { return queue_; }
 
 const MessageQueue& ThreadData::Queue() const noexcept { return queue_; }
 
-const std::thread::id& ThreadData::Id() const noexcept {
-  std::scoped_lock _{*this};
-  return id_;
+LocalTimers& ThreadData::Timers() noexcept { return timers_; }
+
+details::IoPoller& ThreadData::Poller() {
+  std::call_once(poller_created_, [this] { poller_ = std::make_unique<details::IoPoller>(); });
+  return *poller_;
 }
 
-void ThreadData::SetId(const std::thread::id& id) {
-  std::scoped_lock _{*this};
-  id_ = id;
+std::thread::id ThreadData::Id() const noexcept { return LoadAcquire(id_); }
+
+void ThreadData::SetId(const std::thread::id& id) { StoreRelease(id_, id); }
+
+mdo::Thread* ThreadData::Thread() const noexcept { return LoadAcquire(thread_); }
+
+void ThreadData::SetThread(mdo::Thread* thread) noexcept {
+  StoreRelease(thread_, thread);
+}
+
+bool ThreadData::InterruptionRequested() const noexcept {
+  return LoadAcquire(interruption_requested_);
 }
 
-mdo::Thread* ThreadData::Thread() const noexcept {
+void ThreadData::SetInterruptionRequest(bool value) noexcept {
+  StoreRelease(interruption_requested_, value);
+}
+
+bool ThreadData::IsAdopted() const noexcept { return LoadAcquire(is_adopted_); }
+
+void ThreadData::SetIsAdopted(bool value) noexcept {
+  StoreRelease(is_adopted_, value);
+}
+
+WaitOptions ThreadData::WaitOptions() const noexcept {
   std::scoped_lock _{*this};
-  return thread_;
+  return options_.wait;
 }
 
-void ThreadData::SetThread(mdo::Thread* thread) noexcept {
+void ThreadData::SetWaitOptions(const mdo::WaitOptions& options) noexcept {
   std::scoped_lock _{*this};
-  thread_ = std::move(thread);
+  options_.wait = options;
 }
 
-bool ThreadData::InterruptionRequested() const noexcept {
+ThreadOptions ThreadData::Options() const {
   std::scoped_lock _{*this};
-  return interruption_requested_;
+  return options_;
 }
 
-void ThreadData::SetInterruptionRequest(bool value) noexcept {
+void ThreadData::SetOptions(const mdo::ThreadOptions& options) {
   std::scoped_lock _{*this};
-  interruption_requested_ = value;
+  options_ = options;
 }
 
-bool ThreadData::IsAdopted() const noexcept {
+std::string ThreadData::Name() const {
   std::scoped_lock _{*this};
-  return is_adopted_;
+  return name_;
 }
 
-void ThreadData::SetIsAdopted(bool value) noexcept {
+void ThreadData::SetName(const std::string& name) {
   std::scoped_lock _{*this};
-  is_adopted_ = value;
+  name_ = name;
+}
+
+details::ThreadMetrics& ThreadData::Metrics() noexcept { return metrics_; }
+
+ThreadMetricsSnapshot ThreadData::MetricsSnapshot() const {
+  ThreadMetricsSnapshot snapshot;
+
+  snapshot.thread = Name();
+
+  if (snapshot.thread.empty()) {
+    snapshot.thread = ToString(Id());
+  }
+
+  snapshot.posted = queue_.PostedCount();
+  snapshot.dropped = queue_.DroppedCount();
+  snapshot.queue_depth = queue_.Size();
+  snapshot.queue_depth_high_watermark = queue_.MaxSize();
+  snapshot.wait = queue_.AdaptiveWaitStats();
+
+  metrics_.Collect(snapshot);
+
+  return snapshot;
 }
 
 }// namespace mdo
\ No newline at end of file
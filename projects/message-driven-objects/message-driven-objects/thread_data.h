@@ -1,15 +1,40 @@
 #pragma once
 
+#include "io_poller.h"
+#include "local_timers.h"
 #include "locked.h"
 #include "message_queue.h"
+#include "metrics.h"
+#include "thread_options.h"
 
 namespace mdo {
 
 class Thread;
 
+//!
+//! The per-thread state shared by a Thread, its event loop and the producers
+//! posting to the thread.
+//!
+//! The fields read on every dispatched or handled message (the id, the
+//! Thread, the interruption and the adoption flags) are atomics: the id and
+//! the Thread are published with release stores before the thread handles
+//! its first message and read with acquire loads, the flags are plain
+//! acquire/release flags. Only the options and the name are protected by
+//! the mutex, they are read once when the event loop starts.
+//!
 class ThreadData {
  public:
   ThreadData();
+  ~ThreadData();
+
+  ThreadData(const ThreadData&) = delete;
+  ThreadData& operator=(const ThreadData&) = delete;
+
+  //!
+  //! Calls f for each existing ThreadData, the data can't be destroyed
+  //! while f is running.
+  //!
+  static void ForEach(const std::function<void(const ThreadData&)>& f);
 
   void lock() const;
   void unlock() const;
@@ -17,7 +42,15 @@ class ThreadData {
   MessageQueue& Queue() noexcept;
   const MessageQueue& Queue() const noexcept;
 
-  const std::thread::id& Id() const noexcept;
+  LocalTimers& Timers() noexcept;
+
+  //!
+  //! Returns the epoll instance of the thread, it's created on the first
+  //! call (see ThreadOptions::io).
+  //!
+  details::IoPoller& Poller();
+
+  std::thread::id Id() const noexcept;
   void SetId(const std::thread::id& id);
 
   mdo::Thread* Thread() const noexcept;
@@ -29,13 +62,31 @@ class ThreadData {
   bool IsAdopted() const noexcept;
   void SetIsAdopted(bool value) noexcept;
 
+  mdo::WaitOptions WaitOptions() const noexcept;
+  void SetWaitOptions(const mdo::WaitOptions& options) noexcept;
+
+  mdo::ThreadOptions Options() const;
+  void SetOptions(const mdo::ThreadOptions& options);
+
+  std::string Name() const;
+  void SetName(const std::string& name);
+
+  details::ThreadMetrics& Metrics() noexcept;
+  ThreadMetricsSnapshot MetricsSnapshot() const;
+
  private:
   MessageQueue queue_;
+  LocalTimers timers_;
+  std::once_flag poller_created_;
+  std::unique_ptr<details::IoPoller> poller_;
   mutable std::recursive_mutex mutex_;
-  std::thread::id id_;
-  mdo::Thread* thread_;
-  bool interruption_requested_;
-  bool is_adopted_;
+  std::atomic<std::thread::id> id_;
+  std::atomic<mdo::Thread*> thread_;
+  std::atomic_bool interruption_requested_;
+  std::atomic_bool is_adopted_;
+  mdo::ThreadOptions options_;
+  std::string name_;
+  details::ThreadMetrics metrics_;
 };
 
 }// namespace mdo
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "wait_strategy.h"
+
+namespace mdo {
+
+//!
+//! Scheduling policy of a thread.
+//!
+enum class SchedulingPolicy : uint8_t {
+  //!
+  //! The default time-sharing policy of the OS.
+  //!
+  kDefault,
+
+  //!
+  //! Real-time first-in first-out policy (SCHED_FIFO). The thread runs until
+  //! it blocks or a thread of a higher priority becomes runnable. Usually
+  //! requires CAP_SYS_NICE or an RLIMIT_RTPRIO limit on Linux.
+  //!
+  kFifo,
+
+  //!
+  //! Real-time round-robin policy (SCHED_RR), the same as kFifo but the
+  //! threads of the same priority share the CPU by time slices.
+  //!
+  kRoundRobin
+};
+
+//!
+//! Defines what happens to the pending messages when a thread is stopped.
+//!
+enum class StopMode : uint8_t {
+  //!
+  //! The event loop exits as soon as the stop is requested, the pending
+  //! messages stay in the queue and are handled if the thread is started
+  //! again.
+  //!
+  kImmediate,
+
+  //!
+  //! The queue is closed to new messages and the pending ones are handled
+  //! until the queue is empty or the drain timeout expires. The messages
+  //! left after the timeout are dropped, see Thread::DroppedOnStop().
+  //!
+  kDrain
+};
+
+//!
+//! Placement and scheduling of a Thread. The options are applied by the
+//! thread itself when its event loop starts.
+//!
+//! A latency sensitive thread usually is pinned to an isolated core, gets a
+//! real-time priority and busy-polls its queue:
+//!
+//!   thread->SetOptions({
+//!     .cpus = {3},
+//!     .numa_node = 0,
+//!     .policy = SchedulingPolicy::kFifo,
+//!     .priority = 50,
+//!     .wait = {.strategy = WaitStrategy::kBusyPoll},
+//!   });
+//!
+struct ThreadOptions {
+  //!
+  //! CPUs the thread is allowed to run on. The thread isn't pinned if the
+  //! list is empty. The CPU numbers are limited by CPU_SETSIZE on Linux and
+  //! by the bits of the affinity mask on Windows, the thread isn't pinned
+  //! if any of them is out of range.
+  //!
+  std::vector<size_t> cpus;
+
+  //!
+  //! NUMA node the thread prefers to allocate memory from, i.e. the memory
+  //! of the messages extracted by the thread and allocated by the handlers.
+  //! The OS default policy is used if not set. Linux only.
+  //!
+  std::optional<size_t> numa_node;
+
+  SchedulingPolicy policy = SchedulingPolicy::kDefault;
+
+  //!
+  //! Priority for the real-time policies, 1-99 on Linux.
+  //!
+  int priority = 0;
+
+  WaitOptions wait;
+
+  StopMode stop_mode = StopMode::kImmediate;
+
+  //!
+  //! Max time the kDrain mode handles the pending messages. It is checked
+  //! between the batches of messages, so a slow handler can exceed it.
+  //!
+  std::chrono::milliseconds drain_timeout = std::chrono::seconds{1};
+
+  //!
+  //! The event loop waits for the messages and the readiness of the file
+  //! descriptors of its IoNotifiers in one epoll instance, the posted
+  //! messages wake it up through an eventfd. Linux only, elsewhere the loop
+  //! logs an error and waits for the messages only.
+  //!
+  bool io = false;
+};
+
+}// namespace mdo
@@ -0,0 +1,184 @@
+#include "thread_pool.h"
+
+#include "atomic_helpers.h"
+#include "object.h"
+#include "thread.h"
+
+namespace {
+
+//
+// the pool and the index of the worker the current thread belongs to
+//
+thread_local const mdo::ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker_index = 0;
+
+}// namespace
+
+namespace mdo {
+
+ThreadPool::ThreadPool(size_t workers_count, const std::string& name)
+    : name_{name},
+      scheduled_count_{},
+      sleeping_count_{},
+      next_queue_{},
+      running_{},
+      stop_{} {
+  workers_count = std::max<size_t>(workers_count, 1);
+
+  for (size_t i = 0; i < workers_count; ++i) {
+    queues_.push_back(std::make_unique<WorkStealingQueue<StrandPtr>>());
+  }
+}
+
+ThreadPool::~ThreadPool() { Stop(); }
+
+void ThreadPool::Start() {
+  if (running_.exchange(true)) {
+    LOG_WARNING("attempt to start already started thread pool '{}'", name_);
+    return;
+  }
+
+  StoreRelease(stop_, false);
+
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    auto worker = Thread::Create([this, i] { Run(i); });
+    worker->SetName(name_ + "/" + std::to_string(i));
+    worker->Start();
+
+    workers_.push_back(std::move(worker));
+  }
+
+  LOG_TRACE("thread pool '{}' started '{}' workers", name_, workers_.size());
+}
+
+void ThreadPool::Stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+
+  StoreSeqCst(stop_, true);
+
+  {
+    std::scoped_lock _{mutex_};
+  }
+
+  condition_.notify_all();
+
+  for (const auto& worker : workers_) {
+    worker->Stop();
+  }
+
+  workers_.clear();
+
+  LOG_TRACE("thread pool '{}' stopped", name_);
+}
+
+bool ThreadPool::IsRunning() const noexcept { return LoadRelaxed(running_); }
+
+size_t ThreadPool::WorkersCount() const noexcept { return queues_.size(); }
+
+std::error_code ThreadPool::Post(Message&& message) {
+  if (!LoadAcquire(running_)) {
+    LOG_TRACE("thread pool '{}' isn't running so the message is rejected", name_);
+    return std::make_error_code(std::errc::operation_canceled);
+  }
+
+  const ObjectPin pin{std::visit(GetReceiverHandle, message)};
+  const auto receiver = pin.Get();
+
+  if (!receiver) {
+    LOG_TRACE("the receiver of the message is dead so the message is dropped");
+    return std::make_error_code(std::errc::identifier_removed);
+  }
+
+  assert(receiver->Pool() == this);
+
+  const auto& strand = GetStrand(receiver);
+
+  if (strand->Push(std::move(message))) {
+    Schedule(strand);
+  }
+
+  return {};
+}
+
+void ThreadPool::Schedule(StrandPtr strand) {
+  const auto index = current_pool == this
+                       ? current_worker_index
+                       : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+  //
+  // the counter is incremented before pushing the strand, so it never
+  // becomes negative when somebody steals the strand right after the push
+  //
+  scheduled_count_.fetch_add(1, std::memory_order_seq_cst);
+  queues_[index]->Push(std::move(strand));
+
+  if (LoadSeqCst(sleeping_count_) == 0) {
+    return;
+  }
+
+  //
+  // locking the mutex ensures that the sleeping worker either already
+  // waits on the condition or will see the incremented counter
+  //
+  {
+    std::scoped_lock _{mutex_};
+  }
+
+  condition_.notify_one();
+}
+
+void ThreadPool::Run(size_t index) {
+  current_pool = this;
+  current_worker_index = index;
+
+  LOG_TRACE("thread pool '{}' worker '{}' started", name_, index);
+
+  while (!LoadAcquire(stop_)) {
+    auto strand = FindWork(index);
+
+    if (!strand) {
+      WaitForWork();
+      continue;
+    }
+
+    if (strand->Run(kStrandBudget)) {
+      Schedule(std::move(strand));
+    }
+  }
+
+  current_pool = nullptr;
+
+  LOG_TRACE("thread pool '{}' worker '{}' finished", name_, index);
+}
+
+ThreadPool::StrandPtr ThreadPool::FindWork(size_t index) {
+  const auto count = queues_.size();
+
+  for (size_t i = 0; i < count; ++i) {
+    auto& queue = *queues_[(index + i) % count];
+    auto strand = i == 0 ? queue.Pop() : queue.Steal();
+
+    if (strand.has_value()) {
+      scheduled_count_.fetch_sub(1, std::memory_order_seq_cst);
+      return std::move(*strand);
+    }
+  }
+
+  return nullptr;
+}
+
+void ThreadPool::WaitForWork() {
+  std::unique_lock lock{mutex_};
+
+  sleeping_count_.fetch_add(1, std::memory_order_seq_cst);
+
+  condition_.wait(lock, [this] {
+    return LoadSeqCst(stop_) || LoadSeqCst(scheduled_count_) > 0;
+  });
+
+  sleeping_count_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+}// namespace mdo
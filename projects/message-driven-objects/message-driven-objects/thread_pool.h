@@ -0,0 +1,92 @@
+#pragma once
+
+#include "message.h"
+#include "strand.h"
+#include "work_stealing_queue.h"
+
+namespace mdo {
+
+class Thread;
+
+//!
+//! Executor for Objects that don't have a fixed thread affinity.
+//!
+//! An Object constructed with a ThreadPool pointer doesn't live in any
+//! particular thread: its messages are handled by any of the pool workers,
+//! but never by two workers at the same time and always in the order they
+//! were posted (see Strand). It allows to spread CPU heavy objects across
+//! cores without partitioning them to threads manually.
+//!
+//! Each worker has its own work stealing queue of scheduled strands. A strand
+//! scheduled from a worker goes to the worker's own queue, a strand scheduled
+//! from any other thread is distributed between workers in round-robin.
+//! A worker which has no work steals strands from the other workers and
+//! falls asleep only if there is nothing to steal.
+//!
+class ThreadPool final {
+ public:
+  explicit ThreadPool(size_t workers_count = std::thread::hardware_concurrency(),
+                      const std::string& name = "pool");
+
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+
+  ~ThreadPool();
+
+  //!
+  //! Starts the workers.
+  //! If the pool is already running, this function does nothing.
+  //!
+  void Start();
+
+  //!
+  //! Stops the workers. Messages which weren't handled yet stay in the
+  //! strands and would be handled after the next call to Start(), new
+  //! messages are rejected until then.
+  //!
+  void Stop();
+
+  bool IsRunning() const noexcept;
+
+  size_t WorkersCount() const noexcept;
+
+  //!
+  //! Posts a message to the strand of the receiver object.
+  //! The receiver must be bound to this pool.
+  //!
+  //! Returns std::errc::operation_canceled if the pool isn't running or
+  //! std::errc::identifier_removed if the receiver is dead.
+  //!
+  //! Note: This function is thread-safe.
+  //!
+  std::error_code Post(Message&& message);
+
+ private:
+  using StrandPtr = std::shared_ptr<Strand>;
+
+  void Schedule(StrandPtr strand);
+  void Run(size_t index);
+  StrandPtr FindWork(size_t index);
+  void WaitForWork();
+
+ private:
+  //
+  // max number of messages of one strand that a worker handles before
+  // switching to the next strand
+  //
+  static constexpr size_t kStrandBudget = 64;
+
+  std::string name_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+  std::vector<std::unique_ptr<WorkStealingQueue<StrandPtr>>> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::atomic<size_t> scheduled_count_;
+  std::atomic<size_t> sleeping_count_;
+  std::atomic<size_t> next_queue_;
+  std::atomic_bool running_;
+  std::atomic_bool stop_;
+};
+
+}// namespace mdo
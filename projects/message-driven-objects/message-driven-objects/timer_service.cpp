@@ -2,6 +2,7 @@
 
 #include "atomic_helpers.h"
 #include "dispatcher.h"
+#include "message_queue.h"
 #include "thread.h"
 #include "timer_message.h"
 
@@ -14,18 +15,18 @@ class TimerService::Impl {
   static std::atomic<TimerService::Impl*> this_ptr;
 
   struct TimerContext {
-    TimerContext(Object* object, TimerService::Impl* impl, const std::chrono::milliseconds& ms, int id, bool single_shot)
+    TimerContext(Object* object, TimerService::Impl* impl, const std::chrono::nanoseconds& interval, int id, bool single_shot)
         : object{object},
           timer_handle{CreateWaitableTimer(NULL, 0, NULL)},
           impl{impl},
-          ms{ms},
+          interval{interval},
           id{id},
           single_shot{single_shot} {}
 
     Object* object;
     HANDLE timer_handle;
     TimerService::Impl* impl;
-    std::chrono::milliseconds ms;
+    std::chrono::nanoseconds interval;
     int id;
     bool single_shot;
   };
@@ -78,9 +79,9 @@ class TimerService::Impl {
     timer_thread_->Stop();
   }
 
-  int AddTimer(Object* object, const std::chrono::milliseconds& ms, bool single_shot) {
+  int AddTimer(Object* object, const std::chrono::nanoseconds& interval, bool single_shot) {
     int timer_id = NextTimerId();
-    AddTimerImpl(timer_id, object, ms, single_shot);
+    AddTimerImpl(timer_id, object, interval, single_shot);
     return timer_id;
   }
 
@@ -111,18 +112,13 @@ class TimerService::Impl {
 
     RemoveTimer(id);
 
-    AddTimerImpl(context.id, context.object, context.ms, context.single_shot);
+    AddTimerImpl(context.id, context.object, context.interval, context.single_shot);
   }
 
  private:
-  static int NextTimerId() noexcept {
-    static int timer_id = 0;
-    return timer_id++;
-  }
-
-  void AddTimerImpl(int id, Object* object, const std::chrono::milliseconds& ms, bool single_shot) {
+  void AddTimerImpl(int id, Object* object, const std::chrono::nanoseconds& interval, bool single_shot) {
     auto context =
-      std::make_unique<TimerContext>(object, this, ms, id, single_shot);
+      std::make_unique<TimerContext>(object, this, interval, id, single_shot);
 
     std::scoped_lock _{mutex_};
     to_add_.push_back(context.get());
@@ -182,12 +178,16 @@ class TimerService::Impl {
         std::scoped_lock _{mutex_};
 
         for (const auto& context : to_add_) {
-          long long due_ns100 = context->ms.count() * 1000 * -10;
+          //
+          // the due time is set in 100 ns units, but the period only in milliseconds
+          //
+          long long due_ns100 = -std::max<long long>(context->interval.count() / 100, 1);
+          const auto period_ms = std::max<long long>(duration_cast<milliseconds>(context->interval).count(), 1);
 
           bool success = SetWaitableTimer(
             context->timer_handle,
             (LARGE_INTEGER*) &due_ns100,
-            (LONG) context->ms.count(),
+            (LONG) period_ms,
             TimerFunc,
             reinterpret_cast<void*>(context->id),
             1);
@@ -256,15 +256,15 @@ class TimerService::Impl {
 
   void Stop() { managing_thread_->Stop(); }
 
-  int AddTimer(Object* object, const std::chrono::milliseconds& ms, bool single_shot) {
+  int AddTimer(Object* object, const std::chrono::nanoseconds& interval, bool single_shot) {
     int timer_id = NextTimerId();
 
-    SetTimer(timer_id, object, ms, single_shot);
+    SetTimer(timer_id, object, interval, single_shot);
 
     {
       std::scoped_lock _{mutex_};
 
-      contexts_[timer_id] = TimerContext{object, ms, single_shot};
+      contexts_[timer_id] = TimerContext{object, interval, single_shot};
     }
 
     events_count_.fetch_add(1, std::memory_order_relaxed);
@@ -298,16 +298,11 @@ class TimerService::Impl {
 
     const auto& context = it->second;
 
-    SetTimer(id, context.object, context.ms, context.single_shot);
+    SetTimer(id, context.object, context.interval, context.single_shot);
   }
 
  private:
-  static int NextTimerId() noexcept {
-    static std::atomic<int> timer_id = 1;
-    return timer_id.fetch_add(1, std::memory_order_relaxed);
-  }
-
-  void SetTimer(int id, Object* object, const std::chrono::milliseconds& ms, bool single_shot) const {
+  void SetTimer(int id, Object* object, const std::chrono::nanoseconds& interval, bool single_shot) const {
     uint16_t flags = EV_ADD | EV_ENABLE;
 
     if (single_shot) {
@@ -315,7 +310,7 @@ class TimerService::Impl {
     }
 
     struct kevent evt {};
-    EV_SET(&evt, id, EVFILT_TIMER, flags, 0, ms.count(), object);
+    EV_SET(&evt, id, EVFILT_TIMER, flags, NOTE_NSECONDS, interval.count(), object);
 
     if (kevent(kq_, &evt, 1, nullptr, 0, nullptr)) {
       LOG_CRITICAL("cannot add kevent with id: {}", id);
@@ -356,7 +351,7 @@ class TimerService::Impl {
  private:
   struct TimerContext {
     Object* object;
-    std::chrono::milliseconds ms;
+    std::chrono::nanoseconds interval;
     bool single_shot;
   };
 
@@ -370,184 +365,400 @@ class TimerService::Impl {
 
 #else
 
+//
+// Hierarchical timing wheel driven by a single timerfd.
+//
+// The wheel has kWheelLevels levels of kWheelSlots slots. A slot of the first
+// level covers one tick (1 us), a slot of each next level covers the whole
+// previous level. A timer is linked to the slot of the lowest level covering
+// its expiration tick and every time the first level makes a full turn the
+// next slot of the upper level is cascaded down. So starting, killing and
+// resetting a timer is O(1): it's only linking and unlinking of an intrusive
+// list node under the mutex.
+//
+// The timerfd is armed to the tick of the next non-empty slot of the first
+// level or of the next cascade bringing some timers down, the empty levels
+// are skipped entirely, and it's disarmed when there are no timers at all.
+// If the timer thread wakes up late all elapsed ticks are processed at once,
+// a periodic timer which missed several periods ticks only once and expired
+// timers are dispatched in one batch per thread.
+//
 class TimerService::Impl {
  public:
-  Impl() : kq_{epoll_create(1)} {
-    if (kq_ == -1) {
-      SPDLOG_CRITICAL(strerror(errno));
+  Impl()
+      : timer_fd_{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)},
+        wheel_{},
+        levels_counts_{},
+        count_{},
+        current_tick_{},
+        armed_tick_{kNotArmed},
+        start_{steady_clock::now()} {
+    if (timer_fd_ == -1) {
+      LOG_CRITICAL("cannot create timerfd: {}", strerror(errno));
       std::terminate();
     }
   }
 
-  ~Impl() { close(kq_); }
+  ~Impl() {
+    Stop();
+    close(timer_fd_);
+  }
 
   void Start() {
-    if (f_.valid()) {
+    if (thread_.joinable()) {
       return;
     }
 
-    request_interruption_.store(false, std::memory_order_relaxed);
+    thread_ = std::jthread{[this](std::stop_token stop_token) {
+      Thread::SetCurrentThreadName("timer_service");
+
+      //
+      // the default timer slack (50 us) would delay every wakeup much more
+      // than the wheel resolution
+      //
+      Thread::SetCurrentThreadTimerSlack(kTick);
 
-    f_ = std::async(std::launch::async, [this] { TimerThread(); });
+      TimerThread(stop_token);
+    }};
   }
 
   void Stop() {
-    if (!f_.valid()) {
+    if (!thread_.joinable()) {
       return;
     }
 
-    request_interruption_.store(true, std::memory_order_relaxed);
-
-    f_.get();
-  }
+    thread_.request_stop();
 
-  int AddTimer(Object* object, const std::chrono::milliseconds& ms, bool single_shot) {
-    int timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
-
-    if (timer_fd == -1) {
-      SPDLOG_CRITICAL("timer register error: {}", strerror(errno));
+    {
+      //
+      // the tick in the past wakes up the timer thread immediately
+      //
+      std::scoped_lock _{mutex_};
+      Arm(0);
     }
 
-    assert(timer_fd != -1);
+    thread_.join();
+  }
 
-    // register timer_fd in KQ
-    epoll_event event;
-    event.events = EPOLLIN | EPOLLET;
-    event.data.fd = timer_fd;
+  int AddTimer(Object* object, const std::chrono::nanoseconds& interval, bool single_shot) {
+    const auto id = NextTimerId();
 
-    if (epoll_ctl(kq_, EPOLL_CTL_ADD, timer_fd, &event)) {
-      SPDLOG_CRITICAL("cannot add epoll event: {}", strerror(errno));
-      std::terminate();
-    }
+    std::scoped_lock _{mutex_};
 
-    SetTimer(timer_fd, ms, single_shot);
+    auto& timer = timers_[id];
+    timer.object = object;
+    timer.interval = std::max<uint64_t>(std::chrono::ceil<Tick>(interval).count(), 1);
+    timer.id = id;
+    timer.single_shot = single_shot;
 
-    std::scoped_lock _{mutex_};
-    timer_fds_.emplace(timer_fd, TimerContext{ms, single_shot, object});
+    Schedule(timer);
 
-    return timer_fd;
+    return id;
   }
 
   void RemoveTimer(int id) {
     std::scoped_lock _{mutex_};
-    const auto it = timer_fds_.find(id);
+    const auto it = timers_.find(id);
 
-    if (it == timer_fds_.end()) {
+    if (it == timers_.end()) {
       return;
     }
 
-    close(it->first);
-    timer_fds_.erase(it);
+    //
+    // the timerfd is left armed, the timer thread would rearm it on wakeup
+    //
+    Unlink(it->second);
+    timers_.erase(it);
   }
 
   void ResetTimer(int id) {
     std::scoped_lock _{mutex_};
-    const auto it = timer_fds_.find(id);
+    const auto it = timers_.find(id);
 
-    if (it == end(timer_fds_)) {
+    if (it == timers_.end()) {
+      LOG_WARNING("resetting unknown timer id '{}'", id);
       return;
     }
 
-    const auto& context = it->second;
-
-    SetTimer(id, context.ms, context.single_shot);
+    Unlink(it->second);
+    Schedule(it->second);
   }
 
  private:
-  void SetTimer(int id, const std::chrono::milliseconds& ms, bool single_shot) const {
-    const auto seconds =
-      std::chrono::duration_cast<std::chrono::seconds>(ms);
-    const auto nanoseconds =
-      std::chrono::duration_cast<std::chrono::nanoseconds>(ms);
-    const auto remaining_nanoseconds = nanoseconds - seconds;
+  using Tick = microseconds;
+
+  struct Timer {
+    Timer* next = nullptr;
+    Timer** pprev = nullptr;
+    uint64_t expires = 0;
+    uint64_t interval = 0;
+    Object* object = nullptr;
+    int id = 0;
+    uint8_t level = 0;
+    bool single_shot = false;
+  };
 
-    struct itimerspec its {};
-    its.it_value.tv_sec = seconds.count();
-    its.it_value.tv_nsec = remaining_nanoseconds.count();
+  static constexpr Tick kTick{1};
+  static constexpr size_t kWheelLevels = 6;
+  static constexpr size_t kWheelSlotBits = 6;
+  static constexpr size_t kWheelSlots = size_t{1} << kWheelSlotBits;
+
+  //
+  // max distance between the current tick and the slot of a timer (~19 hours),
+  // a more distant timer is linked to the last slot and relinked on cascade
+  //
+  static constexpr uint64_t kMaxDelta = (uint64_t{1} << (kWheelLevels * kWheelSlotBits)) - 1;
+  static constexpr uint64_t kNotArmed = std::numeric_limits<uint64_t>::max();
+
+  static size_t SlotIndex(size_t level, uint64_t tick) noexcept {
+    return (tick >> (level * kWheelSlotBits)) & (kWheelSlots - 1);
+  }
+
+  uint64_t NowTick() const noexcept {
+    return duration_cast<Tick>(steady_clock::now() - start_).count();
+  }
 
-    if (!single_shot) {
-      its.it_interval = its.it_value;
+  void Schedule(Timer& timer) {
+    if (!count_) {
+      //
+      // the idle wheel could fall behind the clock, there is no need
+      // to process the empty ticks
+      //
+      current_tick_ = std::max(current_tick_, NowTick());
     }
 
-    if (timerfd_settime(id, 0, &its, NULL)) {
-      SPDLOG_CRITICAL("set timer error: {}", strerror(errno));
-      std::terminate();
+    //
+    // rounding up guarantees that the timer never fires earlier than requested
+    //
+    timer.expires = std::chrono::ceil<Tick>(steady_clock::now() - start_).count() + timer.interval;
+
+    Link(timer);
+
+    if (timer.expires < armed_tick_) {
+      Arm(timer.expires);
     }
   }
 
-  void TimerThread() {
-    std::vector<struct epoll_event> events;
+  void Link(Timer& timer) {
+    const auto delta = std::min(timer.expires - std::min(timer.expires, current_tick_), kMaxDelta);
 
-    for (; !request_interruption_.load(std::memory_order_relaxed);) {
-      {
-        std::scoped_lock _{mutex_};
-        if (events.size() != timer_fds_.size()) {
-          events.resize(timer_fds_.size());
+    size_t level = 0;
+
+    while (level + 1 < kWheelLevels && delta >> ((level + 1) * kWheelSlotBits)) {
+      ++level;
+    }
+
+    auto& head = wheel_[level][SlotIndex(level, current_tick_ + delta)];
+
+    timer.next = head;
+    timer.pprev = &head;
+    timer.level = static_cast<uint8_t>(level);
+
+    if (head) {
+      head->pprev = &timer.next;
+    }
+
+    head = &timer;
+    ++levels_counts_[level];
+    ++count_;
+  }
+
+  void Unlink(Timer& timer) noexcept {
+    if (!timer.pprev) {
+      return;
+    }
+
+    *timer.pprev = timer.next;
+
+    if (timer.next) {
+      timer.next->pprev = timer.pprev;
+    }
+
+    timer.next = nullptr;
+    timer.pprev = nullptr;
+    --levels_counts_[timer.level];
+    --count_;
+  }
+
+  //
+  // detaches the whole list of the slot and returns its head
+  //
+  Timer* Detach(size_t level, size_t index) noexcept {
+    const auto head = std::exchange(wheel_[level][index], nullptr);
+
+    for (auto timer = head; timer; timer = timer->next) {
+      timer->pprev = nullptr;
+      --levels_counts_[level];
+      --count_;
+    }
+
+    return head;
+  }
+
+  void Cascade(size_t level, size_t index) {
+    for (auto timer = Detach(level, index); timer;) {
+      Link(*std::exchange(timer, timer->next));
+    }
+  }
+
+  //
+  // returns true if the slot of the first level or any slot cascaded at the
+  // tick isn't empty
+  //
+  bool HasWork(uint64_t tick) const noexcept {
+    if (wheel_[0][SlotIndex(0, tick)]) {
+      return true;
+    }
+
+    for (size_t level = 1; level < kWheelLevels && !SlotIndex(level - 1, tick); ++level) {
+      if (wheel_[level][SlotIndex(level, tick)]) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  //
+  // returns the next tick at which something could happen: the next tick if
+  // the first level isn't empty, otherwise the next cascade of the lowest
+  // non-empty level
+  //
+  uint64_t NextCandidateTick(uint64_t tick) const noexcept {
+    size_t level = 0;
+
+    while (level + 1 < kWheelLevels && !levels_counts_[level]) {
+      ++level;
+    }
+
+    const auto step = uint64_t{1} << (level * kWheelSlotBits);
+
+    return (tick | (step - 1)) + 1;
+  }
+
+  void Advance(uint64_t now, std::vector<Message>& expired) {
+    while (current_tick_ <= now && count_) {
+      if (!SlotIndex(0, current_tick_)) {
+        for (size_t level = 1; level < kWheelLevels; ++level) {
+          const auto index = SlotIndex(level, current_tick_);
+          Cascade(level, index);
+
+          if (index) {
+            break;
+          }
         }
       }
 
-      int n = epoll_wait(kq_, events.data(), events.size(), 1000);
+      for (auto timer = Detach(0, SlotIndex(0, current_tick_)); timer;) {
+        Expire(*std::exchange(timer, timer->next), now, expired);
+      }
 
-      for (int i = 0; i < n; ++i) {
-        unsigned long long val;
-        read(events[i].data.fd, &val, 8);
+      //
+      // the wheel must not run ahead of the clock, the timers started later
+      // are linked relative to the current tick
+      //
+      current_tick_ = std::min(NextCandidateTick(current_tick_), now + 1);
+    }
 
-        if (events[i].events & (EPOLLIN | EPOLLERR)) {
-          const auto extract_context = [this](const auto timer_id)
-            -> std::optional<TimerContext> {
-            std::scoped_lock _{mutex_};
+    current_tick_ = std::max(current_tick_, now + 1);
+  }
 
-            const auto it = timer_fds_.find(timer_id);
+  void Expire(Timer& timer, uint64_t now, std::vector<Message>& expired) {
+    expired.emplace_back(TimerMessage{timer.id, nullptr, timer.object});
 
-            if (it == timer_fds_.end()) {
-              return std::nullopt;
-            }
+    if (timer.single_shot) {
+      timers_.erase(timer.id);
+      return;
+    }
 
-            TimerContext ctx = it->second;
+    //
+    // the missed periods are coalesced into the single tick
+    //
+    const auto missed = (now - std::min(now, timer.expires)) / timer.interval;
+    timer.expires += (missed + 1) * timer.interval;
 
-            if (it->second.single_shot) {
-              timer_fds_.erase(it);
-            }
+    Link(timer);
+  }
 
-            return ctx;
-          };
+  uint64_t NextTick() const noexcept {
+    if (!count_) {
+      return kNotArmed;
+    }
 
-          const auto optional_context =
-            extract_context(events[i].data.fd);
+    auto tick = current_tick_;
 
-          if (!optional_context.has_value()) {
-            SPDLOG_WARN(
-              "occurred timer tick for unknown timer id "
-              "'{}', possibly it was deleted",
-              events[i].data.fd);
-            continue;
-          }
+    while (!HasWork(tick)) {
+      tick = NextCandidateTick(tick);
+    }
 
-          SPDLOG_TRACE("dispatching timer tick for timer id: {}",
-                       events[i].data.fd);
-          Dispatcher::Dispatch(std::make_shared<TimerMessage>(
-            events[i].data.fd,
-            nullptr,
-            optional_context->object));
-        }
+    return tick;
+  }
+
+  void Arm(uint64_t tick) {
+    armed_tick_ = tick;
+
+    struct itimerspec its {};
+
+    if (tick != kNotArmed) {
+      const auto deadline = start_.time_since_epoch() + Tick{tick};
+      const auto deadline_seconds = duration_cast<seconds>(deadline);
+
+      its.it_value.tv_sec = deadline_seconds.count();
+      its.it_value.tv_nsec = duration_cast<nanoseconds>(deadline - deadline_seconds).count();
+    }
+
+    if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, nullptr)) {
+      LOG_CRITICAL("set timer error: {}", strerror(errno));
+      std::terminate();
+    }
+  }
+
+  void TimerThread(const std::stop_token& stop_token) {
+    std::vector<Message> expired;
+
+    //
+    // a full kBlock queue of one thread must not stall the timers of the
+    // rest, its ticks are rejected instead
+    //
+    NonBlockingPostScope non_blocking;
+
+    while (!stop_token.stop_requested()) {
+      uint64_t expirations = 0;
+
+      if (read(timer_fd_, &expirations, sizeof(expirations)) != sizeof(expirations) && errno != EINTR) {
+        LOG_CRITICAL("timerfd read error: {}", strerror(errno));
+        std::terminate();
       }
 
-      std::this_thread::yield();
+      {
+        std::scoped_lock _{mutex_};
+        Advance(NowTick(), expired);
+        Arm(NextTick());
+      }
+
+      if (!expired.empty()) {
+        LOG_TRACE("dispatching '{}' timer ticks", expired.size());
+
+        const auto count = expired.size();
+
+        if (const auto error = Dispatcher::Dispatch(expired, MessagePriority::kTimer)) {
+          LOG_WARNING("some of '{}' timer ticks are rejected: {}", count, error.message());
+        }
+      }
     }
   }
 
  private:
-  struct TimerContext {
-    std::chrono::milliseconds ms;
-    bool single_shot;
-    Object* object;
-  };
-
-  int kq_;
-  std::future<void> f_;
+  int timer_fd_;
+  std::jthread thread_;
   mutable std::mutex mutex_;
-  std::map<int, TimerContext> timer_fds_;
-  std::atomic_bool request_interruption_;
+  std::unordered_map<int, Timer> timers_;
+  std::array<std::array<Timer*, kWheelSlots>, kWheelLevels> wheel_;
+  std::array<size_t, kWheelLevels> levels_counts_;
+  size_t count_;
+  uint64_t current_tick_;
+  uint64_t armed_tick_;
+  steady_clock::time_point start_;
 };
 
 #endif
@@ -563,10 +774,15 @@ TimerService* TimerService::Instance() {
   return instance.get();
 }
 
+int TimerService::NextTimerId() noexcept {
+  static std::atomic<int> timer_id = 1;
+  return timer_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 TimerService::~TimerService() { impl_->Stop(); }
 
-int TimerService::AddTimer(NotNull<Object*> object, const milliseconds& ms, bool single_shot) {
-  return impl_->AddTimer(object, ms, single_shot);
+int TimerService::AddTimer(NotNull<Object*> object, const nanoseconds& interval, bool single_shot) {
+  return impl_->AddTimer(object, interval, single_shot);
 }
 
 void TimerService::RemoveTimer(int id) { return impl_->RemoveTimer(id); }
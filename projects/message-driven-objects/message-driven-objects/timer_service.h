@@ -14,9 +14,20 @@ class TimerService {
 
   static TimerService* Instance();
 
+  //!
+  //! Returns the next unique timer identifier. The identifiers are shared
+  //! with the thread local timers (see LocalTimers).
+  //!
+  static int NextTimerId() noexcept;
+
   ~TimerService();
 
-  int AddTimer(NotNull<Object*> object, const milliseconds& ms, bool single_shot = false);
+  //!
+  //! Starts a timer ticking every interval. The resolution of the timers is
+  //! one microsecond on Linux and macOS, on Windows the period of a periodic
+  //! timer is rounded to milliseconds.
+  //!
+  int AddTimer(NotNull<Object*> object, const nanoseconds& interval, bool single_shot = false);
 
   void RemoveTimer(int id);
   void ResetTimer(int id);
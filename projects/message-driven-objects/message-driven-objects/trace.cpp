@@ -0,0 +1,429 @@
+#include "trace.h"
+
+#include "thread.h"
+#include "trace_file.h"
+
+namespace mdo {
+
+namespace details {
+
+std::atomic_bool trace_enabled{false};
+thread_local constinit TraceRing* current_trace_ring = nullptr;
+
+}// namespace details
+
+namespace {
+
+using details::TraceRing;
+
+//
+// releases the ring of an exiting thread
+//
+struct TraceRingOwner {
+  std::shared_ptr<TraceRing> ring;
+
+  ~TraceRingOwner() {
+    if (ring) {
+      details::current_trace_ring = nullptr;
+      ring->Close();
+    }
+  }
+};
+
+thread_local TraceRingOwner current_trace_ring_owner;
+
+//
+// the file being written, accessed only under the tracer's mutex
+//
+struct TraceSession {
+  int fd = -1;
+  std::byte* mapping = nullptr;
+  size_t mapping_size = 0;
+  size_t max_records = 0;
+  size_t records = 0;
+  std::map<uint16_t, std::string> threads;
+  std::map<uint64_t, std::string> types;
+};
+
+class TracerState {
+ public:
+  static TracerState& Instance() {
+    static TracerState instance;
+    return instance;
+  }
+
+  std::error_code Start(const std::filesystem::path& path, const TraceOptions& options);
+  void Stop();
+
+  TraceRing& Register();
+
+  uint64_t Dropped() const noexcept { return LoadRelaxed(dropped_); }
+
+ private:
+  void Flush();
+  void Run(const std::stop_token& stop_token, std::chrono::milliseconds interval);
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<TraceRing>> rings_;
+  uint16_t next_thread_ = 0;
+  size_t ring_capacity_ = TraceOptions{}.ring_capacity;
+  std::optional<TraceSession> session_;
+  std::atomic_uint64_t dropped_{};
+
+  std::mutex flusher_mutex_;
+  std::jthread flusher_;
+};
+
+uint64_t Pack(const ObjectHandle& handle) noexcept {
+  return uint64_t{handle.generation} << 32 | handle.index;
+}
+
+uint64_t Nanoseconds(const std::chrono::steady_clock::time_point& time) noexcept {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+std::error_code LastError() noexcept { return {errno, std::system_category()}; }
+
+TraceRecord MakeRecord(const Message& message, TraceEvent event, uint64_t timestamp, uint64_t enqueued_at) {
+  TraceRecord record{
+    .timestamp = timestamp,
+    .enqueued_at = enqueued_at,
+    .sender = Pack({}),
+    .receiver = Pack({}),
+    .type = message.index(),
+    .payload_size = 0,
+    .thread = 0,
+    .event = event,
+    .reserved = 0};
+
+  std::visit(
+    [&record](const auto& msg) {
+      using T = std::decay_t<decltype(msg)>;
+
+      if constexpr (!std::is_same_v<std::monostate, T>) {
+        record.sender = Pack(msg.SenderHandle());
+        record.receiver = Pack(msg.ReceiverHandle());
+
+        if constexpr (std::is_same_v<AnyMessage, T>) {
+          record.type = reinterpret_cast<uint64_t>(msg.TypeId());
+          record.payload_size = static_cast<uint32_t>(msg.TypeId()->size);
+        } else {
+          record.payload_size = sizeof(T);
+        }
+      }
+    },
+    message);
+
+  return record;
+}
+
+std::error_code TracerState::Start(const std::filesystem::path& path, const TraceOptions& options) {
+#if defined(__linux__) || defined(__APPLE__)
+  std::scoped_lock _{flusher_mutex_, mutex_};
+
+  if (session_) {
+    return std::make_error_code(std::errc::operation_in_progress);
+  }
+
+  TraceSession session;
+
+  session.max_records = options.max_records;
+  session.mapping_size = sizeof(TraceFileHeader) + options.max_records * sizeof(TraceRecord);
+  session.fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  if (session.fd < 0) {
+    return LastError();
+  }
+
+  if (ftruncate(session.fd, static_cast<off_t>(session.mapping_size)) != 0) {
+    const auto error = LastError();
+    close(session.fd);
+    return error;
+  }
+
+  const auto mapping = mmap(nullptr, session.mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, session.fd, 0);
+
+  if (mapping == MAP_FAILED) {
+    const auto error = LastError();
+    close(session.fd);
+    return error;
+  }
+
+  session.mapping = static_cast<std::byte*>(mapping);
+
+  //
+  // the header is valid from the start and its counters are updated by every
+  // flush, so the file of a crashed process is readable (without the names)
+  //
+  const TraceFileHeader header{
+    .magic = TraceFileHeader::kMagic,
+    .version = TraceFileHeader::kVersion,
+    .record_size = sizeof(TraceRecord),
+    .records = 0,
+    .dropped = 0,
+    .names_offset = 0,
+    .names_size = 0,
+    .reserved = {}};
+
+  std::memcpy(session.mapping, &header, sizeof(header));
+
+  //
+  // the records left from the previous session are stale
+  //
+  std::erase_if(rings_, [](const auto& ring) { return ring->IsClosed(); });
+
+  for (const auto& ring : rings_) {
+    ring->Discard();
+    ring->TakeDropped();
+  }
+
+  ring_capacity_ = options.ring_capacity;
+  session_ = std::move(session);
+  StoreRelaxed(dropped_, uint64_t{0});
+
+  flusher_ = std::jthread{[this, interval = options.flush_interval](std::stop_token stop_token) {
+    Thread::SetCurrentThreadName("mdo tracer");
+    Run(stop_token, interval);
+  }};
+
+  StoreRelease(details::trace_enabled, true);
+
+  LOG_INFO("tracing to '{}' started", path.string());
+
+  return {};
+#else
+  (void) path;
+  (void) options;
+  return std::make_error_code(std::errc::not_supported);
+#endif
+}
+
+void TracerState::Stop() {
+#if defined(__linux__) || defined(__APPLE__)
+  std::scoped_lock flusher_lock{flusher_mutex_};
+
+  StoreRelease(details::trace_enabled, false);
+
+  if (flusher_.joinable()) {
+    flusher_.request_stop();
+    flusher_.join();
+  }
+
+  std::scoped_lock _{mutex_};
+
+  if (!session_) {
+    return;
+  }
+
+  Flush();
+
+  auto& session = *session_;
+
+  munmap(session.mapping, session.mapping_size);
+
+  std::string names;
+
+  for (const auto& [index, name] : session.threads) {
+    names += fmt::format("thread {} {}\n", index, name);
+  }
+
+  for (const auto& [type, name] : session.types) {
+    names += fmt::format("type {} {}\n", type, name);
+  }
+
+  TraceFileHeader header{
+    .magic = TraceFileHeader::kMagic,
+    .version = TraceFileHeader::kVersion,
+    .record_size = sizeof(TraceRecord),
+    .records = session.records,
+    .dropped = LoadRelaxed(dropped_),
+    .names_offset = sizeof(TraceFileHeader) + session.records * sizeof(TraceRecord),
+    .names_size = names.size(),
+    .reserved = {}};
+
+  //
+  // the unused tail of the preallocated file is cut off
+  //
+  if (ftruncate(session.fd, static_cast<off_t>(header.names_offset)) != 0 ||
+      pwrite(session.fd, names.data(), names.size(), static_cast<off_t>(header.names_offset)) < 0 ||
+      pwrite(session.fd, &header, sizeof(header), 0) < 0) {
+    LOG_ERROR("failed to complete the trace file: {}", LastError().message());
+  }
+
+  close(session.fd);
+
+  LOG_INFO("tracing stopped, '{}' records written, '{}' dropped", session.records, header.dropped);
+
+  session_.reset();
+#endif
+}
+
+TraceRing& TracerState::Register() {
+  std::string thread_name;
+
+  if (current_thread_data_ptr) {
+    thread_name = current_thread_data_ptr->Name();
+  }
+
+  if (thread_name.empty()) {
+    thread_name = ToString(std::this_thread::get_id());
+  }
+
+  std::scoped_lock _{mutex_};
+
+  auto ring = std::make_shared<TraceRing>(ring_capacity_, next_thread_++, std::move(thread_name));
+
+  rings_.push_back(ring);
+  current_trace_ring_owner.ring = ring;
+  details::current_trace_ring = ring.get();
+
+  return *ring;
+}
+
+void TracerState::Flush() {
+  auto& session = *session_;
+  std::array<TraceRecord, 256> buffer;
+
+  std::erase_if(rings_, [&](const auto& ring) {
+    //
+    // the closed state is read before the records, so the records written
+    // right before the closing aren't lost
+    //
+    const auto closed = ring->IsClosed();
+
+    for (size_t count; (count = ring->Pop(buffer)) != 0;) {
+      session.threads.try_emplace(ring->Thread(), ring->ThreadName());
+
+      const auto stored = std::min(count, session.max_records - session.records);
+
+      for (size_t i = 0; i < stored; ++i) {
+        //
+        // the type info of AnyMessage payloads is static, so its name is
+        // taken here rather than on the hot path
+        //
+        if (const auto type = buffer[i].type; type >= std::variant_size_v<Message>) {
+          session.types.try_emplace(type, reinterpret_cast<MessageTypeId>(type)->name);
+        }
+      }
+
+      std::memcpy(session.mapping + sizeof(TraceFileHeader) + session.records * sizeof(TraceRecord),
+                  buffer.data(),
+                  stored * sizeof(TraceRecord));
+
+      session.records += stored;
+      StoreRelaxed(dropped_, LoadRelaxed(dropped_) + count - stored);
+    }
+
+    StoreRelaxed(dropped_, LoadRelaxed(dropped_) + ring->TakeDropped());
+
+    return closed;
+  });
+
+  auto& header = *reinterpret_cast<TraceFileHeader*>(session.mapping);
+
+  header.records = session.records;
+  header.dropped = LoadRelaxed(dropped_);
+}
+
+void TracerState::Run(const std::stop_token& stop_token, std::chrono::milliseconds interval) {
+  std::mutex mutex;
+  std::condition_variable_any stopped;
+
+  while (!stop_token.stop_requested()) {
+    {
+      std::unique_lock lock{mutex};
+      stopped.wait_for(lock, stop_token, interval, [] { return false; });
+    }
+
+    std::scoped_lock _{mutex_};
+
+    if (session_) {
+      Flush();
+    }
+  }
+}
+
+}// namespace
+
+std::error_code Tracer::Start(const std::filesystem::path& path, const TraceOptions& options) {
+  return TracerState::Instance().Start(path, options);
+}
+
+void Tracer::Stop() { TracerState::Instance().Stop(); }
+
+uint64_t Tracer::Dropped() noexcept { return TracerState::Instance().Dropped(); }
+
+namespace details {
+
+TraceRing::TraceRing(size_t capacity, uint16_t thread, std::string thread_name)
+    : records_{std::make_unique<TraceRecord[]>(std::bit_ceil(std::max<size_t>(capacity, 1)))},
+      mask_{std::bit_ceil(std::max<size_t>(capacity, 1)) - 1},
+      thread_{thread},
+      thread_name_{std::move(thread_name)},
+      head_{},
+      cached_tail_{},
+      dropped_{},
+      tail_{},
+      dropped_taken_{},
+      closed_{} {}
+
+size_t TraceRing::Pop(std::span<TraceRecord> records) noexcept {
+  const auto tail = LoadRelaxed(tail_);
+  const auto count = std::min<size_t>(LoadAcquire(head_) - tail, records.size());
+
+  for (size_t i = 0; i < count; ++i) {
+    records[i] = records_[(tail + i) & mask_];
+  }
+
+  StoreRelease(tail_, tail + count);
+
+  return count;
+}
+
+void TraceRing::Discard() noexcept { StoreRelease(tail_, LoadAcquire(head_)); }
+
+uint64_t TraceRing::TakeDropped() noexcept {
+  const auto dropped = LoadRelaxed(dropped_);
+  return dropped - std::exchange(dropped_taken_, dropped);
+}
+
+void TraceRing::Close() noexcept { StoreRelease(closed_, true); }
+
+bool TraceRing::IsClosed() const noexcept { return LoadAcquire(closed_); }
+
+uint16_t TraceRing::Thread() const noexcept { return thread_; }
+
+const std::string& TraceRing::ThreadName() const noexcept { return thread_name_; }
+
+TraceRing& RegisterTraceRing() { return TracerState::Instance().Register(); }
+
+void TraceDispatched(Message& message) {
+  auto& ring = CurrentTraceRing();
+  const auto now = std::chrono::steady_clock::now();
+
+  //
+  // the enqueue time travels with the message to its handled record
+  //
+  SetPostedAt(message, now);
+
+  auto record = MakeRecord(message, TraceEvent::kDispatched, Nanoseconds(now), 0);
+  record.thread = ring.Thread();
+
+  ring.Push(record);
+}
+
+void TraceHandled(const Message& message) {
+  auto& ring = CurrentTraceRing();
+  const auto posted_at = std::visit(GetPostedAt, message);
+  const auto enqueued_at = posted_at == std::chrono::steady_clock::time_point{} ? 0 : Nanoseconds(posted_at);
+
+  auto record = MakeRecord(message, TraceEvent::kHandled, Nanoseconds(std::chrono::steady_clock::now()), enqueued_at);
+  record.thread = ring.Thread();
+
+  ring.Push(record);
+}
+
+}// namespace details
+
+}// namespace mdo
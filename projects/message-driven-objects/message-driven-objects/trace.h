@@ -0,0 +1,249 @@
+#pragma once
+
+#include "atomic_helpers.h"
+#include "message.h"
+#include "metrics.h"
+
+//!
+//! The hooks recording the messages into the trace, see Tracer. They are
+//! compiled only if MDO_TRACING is defined (the MDO_ENABLE_TRACING option of
+//! CMake), otherwise they expand to nothing.
+//!
+#if defined(MDO_TRACING)
+
+#define MDO_TRACE_DISPATCHED(message)             \
+  do {                                            \
+    if (::mdo::Tracer::Enabled()) {               \
+      ::mdo::details::TraceDispatched(message);   \
+    }                                             \
+  } while (false)
+
+#define MDO_TRACE_HANDLED(message)                \
+  do {                                            \
+    if (::mdo::Tracer::Enabled()) {               \
+      ::mdo::details::TraceHandled(message);      \
+    }                                             \
+  } while (false)
+
+#else
+
+#define MDO_TRACE_DISPATCHED(message) \
+  do {                                \
+  } while (false)
+
+#define MDO_TRACE_HANDLED(message) \
+  do {                             \
+  } while (false)
+
+#endif
+
+namespace mdo {
+
+enum class TraceEvent : uint8_t {
+  //!
+  //! The message is passed to Dispatcher::Dispatch, the timestamp is the
+  //! enqueue time.
+  //!
+  kDispatched = 1,
+
+  //!
+  //! The handler of the message is about to be called, the timestamp is the
+  //! dequeue time.
+  //!
+  kHandled = 2
+};
+
+//!
+//! A record of the trace file. The handles are packed as
+//! generation << 32 | index, the timestamps are nanoseconds of the steady
+//! clock.
+//!
+struct TraceRecord {
+  uint64_t timestamp;
+
+  //!
+  //! The enqueue time of a handled message or 0 if the message wasn't
+  //! dispatched while tracing.
+  //!
+  uint64_t enqueued_at;
+
+  uint64_t sender;
+  uint64_t receiver;
+
+  //!
+  //! The index of the Message alternative for the built-in messages or the
+  //! MessageTypeId of the AnyMessage payload, the names are stored in the
+  //! file (see TraceFile).
+  //!
+  uint64_t type;
+
+  uint32_t payload_size;
+
+  //!
+  //! The index of the thread which wrote the record.
+  //!
+  uint16_t thread;
+
+  TraceEvent event;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 48);
+
+struct TraceOptions {
+  //!
+  //! Max number of records in the file, the records which don't fit are
+  //! dropped. The file is preallocated and memory-mapped.
+  //!
+  size_t max_records = size_t{1} << 20;
+
+  //!
+  //! Number of records a thread buffers between the flushes, rounded up to a
+  //! power of two. A thread's buffer is allocated when it writes the first
+  //! record and is kept while the thread lives, so the option applies only
+  //! to the threads which haven't traced yet. The records which don't fit
+  //! into the buffer are dropped.
+  //!
+  size_t ring_capacity = 8192;
+
+  std::chrono::milliseconds flush_interval = std::chrono::milliseconds{10};
+};
+
+//!
+//! Records the messages exchanged by the objects into a binary file.
+//!
+//! Every dispatched and every handled message is written by the calling
+//! thread into its own lock-free ring buffer as a fixed size TraceRecord,
+//! a background thread moves the records into the memory-mapped file. The
+//! recording takes one clock read and no locks or allocations. The file is
+//! decoded by TraceFile, see also the mdo-trace-decoder tool which prints
+//! the latencies per sender, receiver and message type:
+//!
+//!   Tracer::Start("mdo.trace");
+//!   ...
+//!   Tracer::Stop();
+//!
+//! The hooks are compiled only with MDO_TRACING defined, without it the file
+//! contains no records and tracing costs nothing.
+//!
+class Tracer final {
+ public:
+#if defined(MDO_TRACING)
+  static constexpr bool kCompiledIn = true;
+#else
+  static constexpr bool kCompiledIn = false;
+#endif
+
+  //!
+  //! Creates the file and starts recording. Returns std::errc::operation_in_progress
+  //! if the tracing is already started.
+  //!
+  static std::error_code Start(const std::filesystem::path& path, const TraceOptions& options = {});
+
+  //!
+  //! Stops recording, flushes the buffered records and completes the file.
+  //! Does nothing if the tracing isn't started.
+  //!
+  static void Stop();
+
+  static bool Enabled() noexcept;
+
+  //!
+  //! Returns the number of records dropped since the start because a ring
+  //! buffer or the file was full.
+  //!
+  static uint64_t Dropped() noexcept;
+};
+
+namespace details {
+
+extern std::atomic_bool trace_enabled;
+
+//
+// Single producer single consumer ring of the records written by a thread.
+// The writer caches the read position, so it touches the cache line of the
+// reader only when the ring looks full.
+//
+class TraceRing final {
+ public:
+  TraceRing(size_t capacity, uint16_t thread, std::string thread_name);
+
+  TraceRing(const TraceRing&) = delete;
+  TraceRing& operator=(const TraceRing&) = delete;
+
+  void Push(const TraceRecord& record) noexcept {
+    const auto head = LoadRelaxed(head_);
+
+    if (head - cached_tail_ > mask_) {
+      cached_tail_ = LoadAcquire(tail_);
+
+      if (head - cached_tail_ > mask_) {
+        StoreRelaxed(dropped_, LoadRelaxed(dropped_) + 1);
+        return;
+      }
+    }
+
+    records_[head & mask_] = record;
+    StoreRelease(head_, head + 1);
+  }
+
+  //
+  // the reader side, called only by the flushing thread
+  //
+  size_t Pop(std::span<TraceRecord> records) noexcept;
+  void Discard() noexcept;
+
+  //
+  // returns the number of records dropped since the previous call
+  //
+  uint64_t TakeDropped() noexcept;
+
+  //
+  // called when the writing thread exits, the ring is released once the
+  // reader takes the rest of its records
+  //
+  void Close() noexcept;
+  bool IsClosed() const noexcept;
+
+  uint16_t Thread() const noexcept;
+  const std::string& ThreadName() const noexcept;
+
+ private:
+  std::unique_ptr<TraceRecord[]> records_;
+  size_t mask_;
+  uint16_t thread_;
+  std::string thread_name_;
+
+  alignas(kCacheLineSize) std::atomic_uint64_t head_;
+  uint64_t cached_tail_;
+  std::atomic_uint64_t dropped_;
+
+  alignas(kCacheLineSize) std::atomic_uint64_t tail_;
+  uint64_t dropped_taken_;
+  std::atomic_bool closed_;
+};
+
+//
+// the ring of the calling thread, the constinit raw pointer is read without
+// the TLS wrapper call (the same as current_thread_data_ptr)
+//
+extern thread_local constinit TraceRing* current_trace_ring;
+
+TraceRing& RegisterTraceRing();
+
+inline TraceRing& CurrentTraceRing() {
+  if (current_trace_ring) {
+    return *current_trace_ring;
+  }
+
+  return RegisterTraceRing();
+}
+
+void TraceDispatched(Message& message);
+void TraceHandled(const Message& message);
+
+}// namespace details
+
+inline bool Tracer::Enabled() noexcept { return LoadRelaxed(details::trace_enabled); }
+
+}// namespace mdo
@@ -0,0 +1,168 @@
+#include "trace_file.h"
+
+namespace mdo {
+
+namespace {
+
+//
+// the names of the Message alternatives by their indices
+//
+constexpr std::array<const char*, std::variant_size_v<Message>> kBuiltinTypeNames{
+  "",
+  "InvokeSlotMessage",
+  "TestMessage",
+  "BenchmarkMessage",
+  "SetThreadNameMessage",
+  "TimerMessage",
+  "AnyMessage",
+};
+
+std::error_code ReadAt(std::ifstream& stream, uint64_t offset, void* data, size_t size) {
+  stream.seekg(static_cast<std::streamoff>(offset));
+  stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+
+  if (!stream) {
+    return std::make_error_code(std::errc::io_error);
+  }
+
+  return {};
+}
+
+}// namespace
+
+std::error_code TraceFile::Read(const std::filesystem::path& path, TraceFile& file) {
+  std::ifstream stream{path, std::ios::binary};
+
+  if (!stream) {
+    return std::make_error_code(std::errc::no_such_file_or_directory);
+  }
+
+  TraceFileHeader header{};
+
+  if (const auto error = ReadAt(stream, 0, &header, sizeof(header))) {
+    return error;
+  }
+
+  if (header.magic != TraceFileHeader::kMagic ||
+      header.version != TraceFileHeader::kVersion ||
+      header.record_size != sizeof(TraceRecord)) {
+    return std::make_error_code(std::errc::illegal_byte_sequence);
+  }
+
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+
+  if (error) {
+    return error;
+  }
+
+  //
+  // the counts are checked before allocating, a truncated or damaged file
+  // must not make the reader allocate the memory it claims
+  //
+  if (header.records > (size - sizeof(header)) / sizeof(TraceRecord) ||
+      header.names_size > size ||
+      header.names_offset > size - header.names_size) {
+    return std::make_error_code(std::errc::illegal_byte_sequence);
+  }
+
+  file.records.resize(header.records);
+  file.dropped = header.dropped;
+
+  if (const auto error = ReadAt(stream, sizeof(header), file.records.data(), header.records * sizeof(TraceRecord))) {
+    return error;
+  }
+
+  std::string names(header.names_size, '\0');
+
+  if (const auto error = ReadAt(stream, header.names_offset, names.data(), names.size())) {
+    return error;
+  }
+
+  std::istringstream lines{names};
+
+  for (std::string kind; lines >> kind;) {
+    uint64_t id = 0;
+    std::string name;
+
+    lines >> id;
+    lines.ignore(1);
+    std::getline(lines, name);
+
+    if (kind == "thread") {
+      file.threads[static_cast<uint16_t>(id)] = std::move(name);
+    } else if (kind == "type") {
+      file.types[id] = std::move(name);
+    }
+  }
+
+  return {};
+}
+
+std::string TraceFile::TypeName(uint64_t type) const {
+  if (const auto it = types.find(type); it != types.end()) {
+    return it->second;
+  }
+
+  if (type < kBuiltinTypeNames.size()) {
+    return kBuiltinTypeNames[type];
+  }
+
+  return fmt::format("{:#x}", type);
+}
+
+std::string TraceFile::ThreadName(uint16_t thread) const {
+  if (const auto it = threads.find(thread); it != threads.end()) {
+    return it->second;
+  }
+
+  return std::to_string(thread);
+}
+
+std::vector<TraceEdge> TraceFile::Edges() const {
+  std::vector<TraceEdge> edges;
+  std::map<std::tuple<uint64_t, uint64_t, uint64_t>, size_t> indices;
+
+  for (const auto& record : records) {
+    const auto [it, inserted] = indices.try_emplace({record.sender, record.receiver, record.type}, edges.size());
+
+    if (inserted) {
+      auto& edge = edges.emplace_back();
+
+      edge.sender = record.sender;
+      edge.receiver = record.receiver;
+      edge.type = record.type;
+    }
+
+    auto& edge = edges[it->second];
+
+    if (record.event == TraceEvent::kDispatched) {
+      ++edge.dispatched;
+      continue;
+    }
+
+    ++edge.handled;
+
+    if (record.enqueued_at && record.timestamp >= record.enqueued_at) {
+      edge.latency.Record(std::chrono::nanoseconds{record.timestamp - record.enqueued_at});
+    }
+  }
+
+  std::sort(edges.begin(), edges.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.dispatched + lhs.handled > rhs.dispatched + rhs.handled;
+  });
+
+  return edges;
+}
+
+std::string TraceFile::FormatHandle(uint64_t handle) {
+  const auto index = static_cast<uint32_t>(handle);
+
+  if (index == ObjectHandle::kInvalidIndex) {
+    return "-";
+  }
+
+  return fmt::format("{}:{}", index, static_cast<uint32_t>(handle >> 32));
+}
+
+}// namespace mdo
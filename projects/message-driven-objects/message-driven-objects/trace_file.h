@@ -0,0 +1,79 @@
+#pragma once
+
+#include "histogram.h"
+#include "trace.h"
+
+namespace mdo {
+
+//!
+//! The header at the beginning of the trace file. The records follow the
+//! header, the names of the threads and of the message types follow the
+//! records as text lines "thread <index> <name>" and "type <type> <name>".
+//!
+//! The counters are updated by every flush, so the file of a process which
+//! didn't stop tracing (e.g. crashed) has the flushed records and no names.
+//!
+struct TraceFileHeader {
+  static constexpr std::array<char, 8> kMagic{'M', 'D', 'O', 'T', 'R', 'A', 'C', 'E'};
+  static constexpr uint32_t kVersion = 1;
+
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t records;
+  uint64_t dropped;
+  uint64_t names_offset;
+  uint64_t names_size;
+  std::array<uint8_t, 16> reserved;
+};
+
+static_assert(sizeof(TraceFileHeader) == 64);
+
+//!
+//! The messages of one sender, receiver and message type.
+//!
+struct TraceEdge {
+  uint64_t sender = 0;
+  uint64_t receiver = 0;
+  uint64_t type = 0;
+  uint64_t dispatched = 0;
+  uint64_t handled = 0;
+
+  //!
+  //! Time between the enqueue and the dequeue of the handled messages.
+  //!
+  Histogram latency;
+};
+
+//!
+//! The decoded trace file written by Tracer.
+//!
+struct TraceFile {
+  std::vector<TraceRecord> records;
+  std::map<uint16_t, std::string> threads;
+  std::map<uint64_t, std::string> types;
+  uint64_t dropped = 0;
+
+  static std::error_code Read(const std::filesystem::path& path, TraceFile& file);
+
+  //!
+  //! Returns the name of the type of a record, see TraceRecord::type.
+  //!
+  [[nodiscard]] std::string TypeName(uint64_t type) const;
+
+  [[nodiscard]] std::string ThreadName(uint16_t thread) const;
+
+  //!
+  //! Groups the records by the sender, the receiver and the message type,
+  //! the edges are sorted by the number of messages descending.
+  //!
+  [[nodiscard]] std::vector<TraceEdge> Edges() const;
+
+  //!
+  //! Formats a packed handle of a record as "index:generation" or "-" for
+  //! no object.
+  //!
+  static std::string FormatHandle(uint64_t handle);
+};
+
+}// namespace mdo
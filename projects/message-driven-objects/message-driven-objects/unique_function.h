@@ -0,0 +1,150 @@
+#pragma once
+
+namespace mdo {
+
+template <typename Signature>
+class UniqueFunction;
+
+//!
+//! Move-only counterpart of std::function.
+//!
+//! Unlike std::function it doesn't require the callable to be copyable, so
+//! a closure can own move-only arguments (std::unique_ptr, a moved buffer)
+//! and is moved, not copied, along with the message carrying it. Callables
+//! which fit into kInlineSize bytes and are nothrow movable are stored
+//! inline, larger ones are allocated on the heap, the same way as the
+//! payloads of AnyMessage.
+//!
+template <typename R, typename... Args>
+class UniqueFunction<R(Args...)> final {
+ public:
+  static constexpr size_t kInlineSize = 3 * sizeof(void*);
+
+  UniqueFunction() noexcept = default;
+  UniqueFunction(std::nullptr_t) noexcept {}
+
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, UniqueFunction> &&
+                                        std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+  UniqueFunction(F&& f) {
+    using Callable = std::decay_t<F>;
+
+    if constexpr (std::is_pointer_v<Callable> || std::is_member_pointer_v<Callable> ||
+                  std::is_same_v<Callable, std::function<R(Args...)>>) {
+      if (!f) {
+        return;
+      }
+    }
+
+    if constexpr (IsStoredInline<Callable>()) {
+      new (&storage_) Callable(std::forward<F>(f));
+    } else {
+      new (&storage_) Callable*(new Callable(std::forward<F>(f)));
+    }
+
+    operations_ = &kOperations<Callable>;
+  }
+
+  UniqueFunction(UniqueFunction&& other) noexcept : operations_{other.operations_} {
+    if (operations_) {
+      operations_->move(&other.storage_, &storage_);
+      other.operations_ = nullptr;
+    }
+  }
+
+  UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    Reset();
+
+    operations_ = other.operations_;
+
+    if (operations_) {
+      operations_->move(&other.storage_, &storage_);
+      other.operations_ = nullptr;
+    }
+
+    return *this;
+  }
+
+  UniqueFunction& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  UniqueFunction(const UniqueFunction& other) = delete;
+  UniqueFunction& operator=(const UniqueFunction& other) = delete;
+
+  ~UniqueFunction() { Reset(); }
+
+  explicit operator bool() const noexcept { return operations_; }
+
+  R operator()(Args... args) {
+    assert(operations_);
+    return operations_->invoke(&storage_, std::forward<Args>(args)...);
+  }
+
+ private:
+  struct Operations {
+    R (*invoke)(void* storage, Args&&... args);
+    void (*move)(void* from, void* to) noexcept;
+    void (*destroy)(void* storage) noexcept;
+  };
+
+  template <typename T>
+  static constexpr bool IsStoredInline() noexcept {
+    return sizeof(T) <= kInlineSize &&
+           alignof(T) <= alignof(void*) &&
+           std::is_nothrow_move_constructible_v<T>;
+  }
+
+  template <typename T>
+  static T& Get(void* storage) noexcept {
+    if constexpr (IsStoredInline<T>()) {
+      return *std::launder(reinterpret_cast<T*>(storage));
+    } else {
+      return **std::launder(reinterpret_cast<T**>(storage));
+    }
+  }
+
+  template <typename T>
+  static R Invoke(void* storage, Args&&... args) {
+    return std::invoke(Get<T>(storage), std::forward<Args>(args)...);
+  }
+
+  template <typename T>
+  static void Move(void* from, void* to) noexcept {
+    if constexpr (IsStoredInline<T>()) {
+      new (to) T(std::move(Get<T>(from)));
+      Get<T>(from).~T();
+    } else {
+      new (to) T*(*std::launder(reinterpret_cast<T**>(from)));
+    }
+  }
+
+  template <typename T>
+  static void Destroy(void* storage) noexcept {
+    if constexpr (IsStoredInline<T>()) {
+      Get<T>(storage).~T();
+    } else {
+      delete &Get<T>(storage);
+    }
+  }
+
+  template <typename T>
+  static inline const Operations kOperations{&Invoke<T>, &Move<T>, &Destroy<T>};
+
+  void Reset() noexcept {
+    if (operations_) {
+      std::exchange(operations_, nullptr)->destroy(&storage_);
+    }
+  }
+
+ private:
+  const Operations* operations_ = nullptr;
+  alignas(void*) std::byte storage_[kInlineSize];
+};
+
+}// namespace mdo
@@ -8,4 +8,10 @@ Thread* Utils::CurrentThread() { return Thread::Current(); }
 
 bool Utils::IsThreadRunning(Thread* thread) { return thread->IsRunning(); }
 
+std::shared_ptr<ThreadData> Utils::ThreadDataOf(Thread* thread) {
+  return thread ? GetThreadData(thread) : nullptr;
+}
+
+const ThreadData* Utils::CurrentThreadData() noexcept { return current_thread_data_ptr; }
+
 }// namespace mdo
\ No newline at end of file
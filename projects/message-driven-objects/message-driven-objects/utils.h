@@ -3,6 +3,7 @@
 namespace mdo {
 
 class Thread;
+class ThreadData;
 
 class Utils final {
  public:
@@ -20,6 +21,18 @@ class Utils final {
   // Returns true if thread is running
   //
   static bool IsThreadRunning(Thread* thread);
+
+  //
+  // Returns the data of the thread or nullptr if the thread is nullptr.
+  // Used to cache the thread affinity of a signal receiver.
+  //
+  static std::shared_ptr<ThreadData> ThreadDataOf(Thread* thread);
+
+  //
+  // Returns the data of the calling thread without locking anything or
+  // nullptr if the thread has no data yet, i.e. no object lives in it.
+  //
+  static const ThreadData* CurrentThreadData() noexcept;
 };
 
 }// namespace mdo
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+namespace mdo {
+
+namespace details {
+
+//
+// hints the CPU that the thread spins, it saves power and lets the sibling
+// hyper-thread run
+//
+inline void CpuRelax() noexcept {
+#if defined(_WIN32)
+  YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+//
+// std::atomic::wait() spins and yields before sleeping, which costs the
+// woken thread its time slice when both threads share a core, so the futex
+// is used directly where it's available
+//
+inline void WaitWhileEqual(std::atomic_uint32_t& value, uint32_t expected) noexcept {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  value.wait(expected, std::memory_order_acquire);
+#endif
+}
+
+#if defined(__linux__)
+
+//
+// the same but returns once the timeout expires, there is no portable
+// equivalent of the timed wait
+//
+inline void WaitWhileEqualFor(std::atomic_uint32_t& value,
+                              uint32_t expected,
+                              const std::chrono::nanoseconds& timeout) noexcept {
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+
+  const timespec relative{
+    .tv_sec = static_cast<time_t>(seconds.count()),
+    .tv_nsec = static_cast<long>((timeout - seconds).count())};
+
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, &relative, nullptr, 0);
+}
+
+#endif
+
+inline void WakeAll(std::atomic_uint32_t& value) noexcept {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+  value.notify_all();
+#endif
+}
+
+}// namespace details
+
+}// namespace mdo
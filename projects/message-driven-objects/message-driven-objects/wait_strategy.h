@@ -0,0 +1,72 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Defines how the event loop of a Thread waits for the next message or the
+//! nearest deadline of its local timers.
+//!
+enum class WaitStrategy : uint8_t {
+  //!
+  //! The thread sleeps on the queue until a message arrives or the nearest
+  //! timer expires. The cheapest strategy, but the wakeup latency depends on
+  //! the OS scheduler (tens of microseconds).
+  //!
+  kSleep,
+
+  //!
+  //! The thread sleeps until the nearest deadline minus the spin threshold
+  //! and then polls the queue without sleeping until the deadline. Gives
+  //! microsecond precision of the timers at the cost of the spinning time.
+  //!
+  kHybrid,
+
+  //!
+  //! The thread never sleeps and polls the queue in a loop. Gives the lowest
+  //! latency of the messages and the timers but occupies the whole core.
+  //!
+  kBusyPoll,
+
+  //!
+  //! The thread waits in stages: spins checking the queue without locking
+  //! it for the spin budget, then yields the CPU for the yield budget and
+  //! only then sleeps on a futex (on the condition variable elsewhere than
+  //! Linux). When the messages arrive back-to-back the thread picks them up
+  //! with the latency close to kBusyPoll, an idle thread sleeps like with
+  //! kSleep. The producers make the wakeup system call only while the
+  //! thread sleeps. See WaitStats for how often each stage is hit.
+  //!
+  kAdaptive
+};
+
+struct WaitOptions {
+  WaitStrategy strategy = WaitStrategy::kSleep;
+
+  //!
+  //! For kHybrid strategy: the thread stops sleeping this time before the
+  //! nearest deadline.
+  //!
+  std::chrono::nanoseconds spin_threshold = std::chrono::microseconds{100};
+
+  //!
+  //! For kAdaptive strategy: how long the thread spins and then yields
+  //! before sleeping. The spinning makes sense only if the producer runs on
+  //! another core.
+  //!
+  std::chrono::nanoseconds spin_budget = std::chrono::microseconds{20};
+  std::chrono::nanoseconds yield_budget = std::chrono::microseconds{50};
+};
+
+//!
+//! The number of waits of the kAdaptive strategy by the stage which ended
+//! them: a message or the interruption was found while spinning, while
+//! yielding, after sleeping or the wait timed out.
+//!
+struct WaitStats {
+  uint64_t spun = 0;
+  uint64_t yielded = 0;
+  uint64_t parked = 0;
+  uint64_t timed_out = 0;
+};
+
+}// namespace mdo
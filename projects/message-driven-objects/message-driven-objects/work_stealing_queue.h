@@ -0,0 +1,60 @@
+#pragma once
+
+namespace mdo {
+
+//!
+//! Per worker queue of a ThreadPool.
+//!
+//! The owning worker pushes and pops items from the front/back in FIFO order
+//! (so all strands scheduled on the worker get their turn), idle workers steal
+//! items from the back, i.e. they take the most recently scheduled work that
+//! the owner would reach last.
+//!
+//! Each worker has its own queue and own mutex, so the workers do not contend
+//! with each other until one of them runs out of work and starts stealing.
+//!
+template <typename T>
+class WorkStealingQueue final {
+ public:
+  void Push(T item) {
+    std::scoped_lock _{mutex_};
+    items_.push_back(std::move(item));
+  }
+
+  std::optional<T> Pop() {
+    std::scoped_lock _{mutex_};
+
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+
+    auto item = std::move(items_.front());
+    items_.pop_front();
+
+    return item;
+  }
+
+  std::optional<T> Steal() {
+    std::scoped_lock _{mutex_};
+
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+
+    auto item = std::move(items_.back());
+    items_.pop_back();
+
+    return item;
+  }
+
+  size_t Size() const noexcept {
+    std::scoped_lock _{mutex_};
+    return items_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<T> items_;
+};
+
+}// namespace mdo
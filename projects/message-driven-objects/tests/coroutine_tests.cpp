@@ -0,0 +1,209 @@
+#include "awaitables.h"
+#include "dispatcher.h"
+#include "future.h"
+#include "task.h"
+#include "test_helpers.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(CoroutineTests, CallAsyncAndSleepResumeInOwnThread) {
+  class B : public Object {
+   public:
+    explicit B(mdo::Thread* thread) : Object{thread} {}
+
+    int Square(int value) {
+      EXPECT_EQ(Thread(), Thread::Current());
+      return value * value;
+    }
+  };
+
+  class A : public Object {
+   public:
+    explicit A(B* b) : b_{b}, result_{}, done_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() { Run(); }
+
+    int Result() const noexcept { return result_; }
+
+    bool Done() const noexcept { return done_; }
+
+   private:
+    Task Run() {
+      const auto square = co_await CallAsync(b_, &B::Square, 7);
+      EXPECT_EQ(Thread(), Thread::Current());
+
+      const auto started = std::chrono::steady_clock::now();
+      co_await Sleep(50ms);
+      EXPECT_EQ(Thread(), Thread::Current());
+      EXPECT_GE(std::chrono::steady_clock::now() - started, 50ms);
+
+      EXPECT_TRUE(square.has_value());
+      result_ = square.value_or(0);
+      done_ = true;
+    }
+
+   private:
+    B* b_;
+    int result_;
+    std::atomic_bool done_;
+  };
+
+  const auto thread = Thread::Create("background");
+  const auto b = std::make_shared<B>(thread.get());
+  const auto a = std::make_shared<A>(b.get());
+
+  auto future = std::async(std::launch::async, [&a] {
+    WaitUntil([&a] { return a->Done(); });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_TRUE(a->Done());
+  EXPECT_EQ(a->Result(), 49);
+}
+
+TEST(CoroutineTests, CallAsyncResumesWithErrorWhenCallIsDropped) {
+  class B : public Object {
+   public:
+    explicit B(mdo::Thread* thread) : Object{thread} {}
+
+    int Square(int value) { return value * value; }
+  };
+
+  class A : public Object {
+   public:
+    explicit A(B* b) : b_{b}, suspended_{}, done_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() { Run(); }
+
+    bool Suspended() const noexcept { return suspended_; }
+
+    bool Done() const noexcept { return done_; }
+
+    std::error_code Error() const noexcept { return error_; }
+
+   private:
+    Task Run() {
+      suspended_ = true;
+
+      const auto square = co_await CallAsync(b_, &B::Square, 7);
+      EXPECT_EQ(Thread(), Thread::Current());
+      EXPECT_FALSE(square.has_value());
+
+      if (!square) {
+        error_ = square.error();
+      }
+
+      done_ = true;
+    }
+
+   private:
+    B* b_;
+    std::atomic_bool suspended_;
+    std::atomic_bool done_;
+    std::error_code error_;
+  };
+
+  auto& dispatcher = Dispatcher::Instance();
+  const auto thread = Thread::Create("background");
+  auto idle_thread = Thread::Create("never started");
+  auto b = std::make_shared<B>(idle_thread.get());
+  const auto a = std::make_shared<A>(b.get());
+
+  auto future = std::async(std::launch::async, [&] {
+    EXPECT_TRUE(WaitUntil([&a] { return a->Suspended(); }));
+
+    //
+    // the call is queued to the thread which never runs, destroying the
+    // thread destroys the message which cancels the call
+    //
+    b.reset();
+    idle_thread.reset();
+
+    EXPECT_TRUE(WaitUntil([&a] { return a->Done(); }));
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  dispatcher.Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_TRUE(a->Done());
+  EXPECT_EQ(a->Error(), std::errc::operation_canceled);
+}
+
+TEST(CoroutineTests, FrameIsDestroyedWhenObjectIsDead) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread, std::shared_ptr<int> sentinel)
+        : Object{thread},
+          sentinel_{std::move(sentinel)},
+          suspended_{} {
+      //
+      // the queued connection makes the object current in the handler, so
+      // the coroutine is resumed through the object, not its thread
+      //
+      Thread()->Started.Connect(this, &A::OnThreadStarted, ConnectionType::kQueued);
+    }
+
+    void OnThreadStarted() { Run(std::move(sentinel_)); }
+
+    bool Suspended() const noexcept { return suspended_; }
+
+   private:
+    Task Run(std::shared_ptr<int> sentinel) {
+      EXPECT_TRUE(sentinel);
+      suspended_ = true;
+      co_await Sleep(50ms);
+      ADD_FAILURE() << "the coroutine of the dead object is resumed";
+    }
+
+   private:
+    std::shared_ptr<int> sentinel_;
+    std::atomic_bool suspended_;
+  };
+
+  auto& dispatcher = Dispatcher::Instance();
+  auto sentinel = std::make_shared<int>();
+  const std::weak_ptr<int> observer = sentinel;
+
+  const auto thread = Thread::Create("background");
+  auto a = std::make_shared<A>(thread.get(), std::move(sentinel));
+
+  auto future = std::async(std::launch::async, [&] {
+    EXPECT_TRUE(WaitUntil([&a] { return a->Suspended(); }));
+
+    //
+    // the timer tick can't resume the coroutine of the dead object, so the
+    // coroutine frame owning the sentinel is destroyed
+    //
+    a.reset();
+
+    EXPECT_TRUE(WaitUntil([&observer] { return observer.expired(); }));
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  dispatcher.Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_TRUE(observer.expired());
+}
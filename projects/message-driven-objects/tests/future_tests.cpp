@@ -0,0 +1,217 @@
+#include "dispatcher.h"
+#include "future.h"
+#include "task.h"
+#include "test_helpers.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace tests;
+
+namespace {
+
+class Calculator : public Object {
+ public:
+  explicit Calculator(mdo::Thread* thread) : Object{thread}, calls_{} {}
+
+  int Square(int value) {
+    EXPECT_EQ(Thread(), Thread::Current());
+    ++calls_;
+    return value * value;
+  }
+
+  void Touch() { ++calls_; }
+
+  size_t Calls() const noexcept { return calls_; }
+
+ private:
+  std::atomic_size_t calls_;
+};
+
+}// namespace
+
+TEST(FutureTests, GetBlocksUntilCompleted) {
+  auto& dispatcher = Dispatcher::Instance();
+  const auto thread = Thread::Create("calculator");
+  const auto calculator = std::make_shared<Calculator>(thread.get());
+
+  auto future = std::async(std::launch::async, [&calculator] {
+    WaitForDispatcher();
+
+    for (int i = 0; i < 100; ++i) {
+      const auto result = Invoke(calculator.get(), &Calculator::Square, i).Get();
+
+      EXPECT_TRUE(result.has_value());
+      EXPECT_EQ(result.value_or(0), i * i);
+    }
+
+    EXPECT_TRUE(Invoke(calculator.get(), &Calculator::Touch).Get().has_value());
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  dispatcher.Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_EQ(calculator->Calls(), 101);
+}
+
+TEST(FutureTests, CanceledWhenMessageIsDropped) {
+  auto& dispatcher = Dispatcher::Instance();
+  auto thread = Thread::Create("never started");
+  auto calculator = std::make_shared<Calculator>(thread.get());
+
+  auto future = std::async(std::launch::async, [&thread, &calculator] {
+    WaitForDispatcher();
+
+    auto square = Invoke(calculator.get(), &Calculator::Square, 2);
+
+    EXPECT_FALSE(square.IsReady());
+
+    calculator.reset();
+    thread.reset();
+
+    const auto result = square.Get();
+
+    EXPECT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), std::errc::operation_canceled);
+
+    Dispatcher::Quit();
+  });
+
+  dispatcher.Exec();
+
+  future.get();
+}
+
+TEST(FutureTests, ThenAndAwaitResumeInCallerThread) {
+  class Client : public Object {
+   public:
+    explicit Client(Calculator* calculator) : calculator_{calculator}, sum_{}, done_{} {
+      Thread()->Started.Connect(this, &Client::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      Invoke(calculator_, &Calculator::Square, 3).Then([this](auto result) {
+        EXPECT_EQ(Thread(), Thread::Current());
+        sum_ += *result;
+        Run();
+      });
+    }
+
+    int Sum() const noexcept { return sum_; }
+
+    bool Done() const noexcept { return done_; }
+
+   private:
+    Task Run() {
+      for (int i = 0; i < 10; ++i) {
+        const auto result = co_await Invoke(calculator_, &Calculator::Square, i);
+        EXPECT_EQ(Thread(), Thread::Current());
+        sum_ += *result;
+      }
+
+      done_ = true;
+    }
+
+   private:
+    Calculator* calculator_;
+    int sum_;
+    std::atomic_bool done_;
+  };
+
+  const auto thread = Thread::Create("calculator");
+  const auto calculator = std::make_shared<Calculator>(thread.get());
+  const auto client = std::make_shared<Client>(calculator.get());
+
+  auto future = std::async(std::launch::async, [&client] {
+    WaitUntil([&client] { return client->Done(); });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_TRUE(client->Done());
+  EXPECT_EQ(client->Sum(), 9 + 285);
+}
+
+TEST(FutureTests, DroppedContinuationIsReleased) {
+  class Client : public Object {
+   public:
+    Client(mdo::Thread* thread, Calculator* calculator, std::shared_ptr<int> sentinel)
+        : Object{thread},
+          calculator_{calculator},
+          sentinel_{std::move(sentinel)},
+          invoked_{},
+          called_{} {
+      //
+      // the queued connection makes the client current in the handler, so
+      // the continuation is posted to the client, not to its thread object
+      //
+      Thread()->Started.Connect(this, &Client::OnThreadStarted, ConnectionType::kQueued);
+    }
+
+    void OnThreadStarted() {
+      Invoke(calculator_, &Calculator::Square, 3).Then([this, sentinel = std::move(sentinel_)](auto) {
+        called_ = true;
+      });
+
+      invoked_ = true;
+    }
+
+    bool Invoked() const noexcept { return invoked_; }
+
+    bool Called() const noexcept { return called_; }
+
+   private:
+    Calculator* calculator_;
+    std::shared_ptr<int> sentinel_;
+    std::atomic_bool invoked_;
+    std::atomic_bool called_;
+  };
+
+  auto& dispatcher = Dispatcher::Instance();
+  auto sentinel = std::make_shared<int>();
+  const std::weak_ptr<int> observer = sentinel;
+
+  auto client_thread = Thread::Create("client");
+  const auto calculator_thread = Thread::Create("calculator");
+  const auto calculator = std::make_shared<Calculator>(calculator_thread.get());
+  auto client = std::make_shared<Client>(client_thread.get(), calculator.get(), std::move(sentinel));
+
+  auto future = std::async(std::launch::async, [&] {
+    WaitForDispatcher();
+
+    client_thread->Start();
+    EXPECT_TRUE(WaitUntil([&client] { return client->Invoked(); }));
+    client_thread->Stop();
+
+    //
+    // the continuation is queued to the stopped thread and destroyed along
+    // with the thread without being called
+    //
+    calculator_thread->Start();
+    EXPECT_TRUE(WaitUntil([&calculator] { return calculator->Calls() == 1; }));
+    calculator_thread->Stop();
+
+    EXPECT_FALSE(client->Called());
+
+    client.reset();
+    client_thread.reset();
+
+    EXPECT_TRUE(observer.expired());
+
+    Dispatcher::Quit();
+  });
+
+  dispatcher.Exec();
+
+  future.get();
+}
@@ -0,0 +1,54 @@
+#include "histogram.h"
+
+using namespace mdo;
+
+TEST(HistogramTests, BucketsAreLogLinear) {
+  for (uint64_t value = 0; value < Histogram::kSubBucketCount; ++value) {
+    EXPECT_EQ(Histogram::BucketUpperBound(Histogram::BucketIndex(value)), value);
+  }
+
+  for (uint64_t value = Histogram::kSubBucketCount; value < Histogram::kMaxValue; value = value * 3 / 2 + 1) {
+    const auto index = Histogram::BucketIndex(value);
+    const auto upper = Histogram::BucketUpperBound(index);
+
+    EXPECT_GE(upper, value);
+    EXPECT_LT(static_cast<double>(upper - value) / static_cast<double>(value), 2.0 / Histogram::kSubBucketCount);
+    EXPECT_EQ(Histogram::BucketIndex(upper), index);
+    EXPECT_EQ(Histogram::BucketIndex(upper + 1), index + 1);
+  }
+
+  EXPECT_EQ(Histogram::BucketIndex(Histogram::kMaxValue), Histogram::kBucketCount - 1);
+  EXPECT_EQ(Histogram::BucketIndex(std::numeric_limits<uint64_t>::max()), Histogram::kBucketCount - 1);
+}
+
+TEST(HistogramTests, PercentilesAndMerge) {
+  Histogram lower;
+  Histogram upper;
+
+  for (int64_t i = 1; i <= 1000; ++i) {
+    (i <= 500 ? lower : upper).Record(std::chrono::microseconds{i});
+  }
+
+  Histogram histogram;
+  histogram.Merge(lower);
+  histogram.Merge(upper);
+
+  EXPECT_EQ(histogram.Count(), 1000);
+  EXPECT_EQ(histogram.Min(), 1us);
+  EXPECT_EQ(histogram.Max(), 1000us);
+  EXPECT_EQ(histogram.Mean(), 500500ns);
+
+  for (const auto& [p, expected] : {std::pair{50.0, 500us}, {90.0, 900us}, {99.0, 990us}, {99.9, 999us}}) {
+    const auto value = histogram.Percentile(p);
+    const auto expected_ns = std::chrono::nanoseconds{expected};
+
+    EXPECT_GE(value, expected_ns);
+    EXPECT_LE(value.count(), expected_ns.count() * 1.016);
+  }
+
+  EXPECT_EQ(histogram.Percentile(100), 1000us);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Percentile(50), 0ns);
+}
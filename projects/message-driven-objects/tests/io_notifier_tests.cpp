@@ -0,0 +1,105 @@
+#include "io_notifier.h"
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace tests;
+
+#if defined(__linux__)
+
+TEST(IoNotifierTests, ReadinessIsHandledInOwnerThread) {
+  class Reader : public Object {
+   public:
+    Reader(mdo::Thread* thread, int fd)
+        : Object{thread},
+          fd_{fd},
+          bytes_{},
+          messages_{} {}
+
+    void OnReady(IoEvents events) {
+      EXPECT_EQ(Thread(), Thread::Current());
+      EXPECT_TRUE(HasEvents(events, IoEvents::kRead));
+
+      std::array<char, 64> buffer;
+
+      if (const auto size = read(fd_, buffer.data(), buffer.size()); size > 0) {
+        bytes_ += static_cast<size_t>(size);
+      }
+    }
+
+    void OnTestMessage(TestMessage&) override {
+      EXPECT_EQ(Thread(), Thread::Current());
+      ++messages_;
+    }
+
+    size_t Bytes() const noexcept { return bytes_; }
+
+    size_t Messages() const noexcept { return messages_; }
+
+   private:
+    int fd_;
+    std::atomic_size_t bytes_;
+    std::atomic_size_t messages_;
+  };
+
+  constexpr size_t kWrites = 100;
+
+  std::array<int, 2> pipe_fds{};
+  ASSERT_EQ(pipe2(pipe_fds.data(), O_NONBLOCK | O_CLOEXEC), 0);
+
+  const auto thread = Thread::Create("io");
+  const auto reader = MakeUnique<Reader>(thread.get(), pipe_fds[0]);
+  const auto notifier = MakeUnique<IoNotifier>(thread.get(), pipe_fds[0], IoEvents::kRead);
+  auto& queue = GetThreadData(thread.get())->Queue();
+
+  ASSERT_FALSE(notifier->Error());
+  notifier->Ready.Connect(reader.get(), &Reader::OnReady);
+
+  ThreadOptions options;
+  options.io = true;
+
+  thread->SetOptions(options);
+  thread->Start();
+
+  //
+  // the loop sleeps in epoll_wait(), both the descriptor and the posted
+  // messages must wake it up
+  //
+  for (size_t i = 0; i < kWrites; ++i) {
+    ASSERT_EQ(write(pipe_fds[1], "x", 1), 1);
+    ASSERT_FALSE(queue.Post(TestMessage{"", nullptr, reader.get()}));
+
+    if (i % 10 == 0) {
+      Thread::Sleep(1ms);
+    }
+  }
+
+  WaitUntil([&reader] { return reader->Bytes() >= kWrites && reader->Messages() >= kWrites; });
+
+  thread->Stop();
+
+  EXPECT_EQ(reader->Bytes(), kWrites);
+  EXPECT_EQ(reader->Messages(), kWrites);
+
+  close(pipe_fds[1]);
+  close(pipe_fds[0]);
+}
+
+TEST(IoNotifierTests, StopWakesUpSleepingLoop) {
+  const auto thread = Thread::Create("io idle");
+
+  ThreadOptions options;
+  options.io = true;
+
+  thread->SetOptions(options);
+  thread->Start();
+
+  WaitUntil([&thread] { return thread->State() == ThreadState::kRunning; });
+
+  thread->Stop();
+
+  EXPECT_EQ(thread->State(), ThreadState::kStopped);
+}
+
+#endif
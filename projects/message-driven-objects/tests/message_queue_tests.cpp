@@ -0,0 +1,263 @@
+#include "message_queue.h"
+
+using namespace mdo;
+
+TEST(MessageQueueTests, HigherLanesOvertakeFloodedBulkLane) {
+  MessageQueue queue;
+
+  for (size_t i = 0; i < 10 * MessageQueue::kBatchSize; ++i) {
+    queue.Post(TestMessage{"bulk", nullptr, nullptr});
+  }
+
+  queue.Post(TimerMessage{1, nullptr, nullptr});
+  queue.Post(SetThreadNameMessage{"control"});
+  queue.Post(TestMessage{"normal", nullptr, nullptr}, MessagePriority::kNormal);
+
+  std::vector<Message> messages;
+  ASSERT_FALSE(queue.Poll(messages));
+
+  ASSERT_EQ(messages.size(), MessageQueue::kBatchSize + 1);
+  EXPECT_TRUE(std::holds_alternative<SetThreadNameMessage>(messages[0]));
+  EXPECT_TRUE(std::holds_alternative<TimerMessage>(messages[1]));
+  EXPECT_EQ(std::get<TestMessage>(messages[2]).Data(), "normal");
+  EXPECT_EQ(std::get<TestMessage>(messages[3]).Data(), "bulk");
+}
+
+TEST(MessageQueueTests, StarvingLaneGetsQuota) {
+  MessageQueue queue;
+
+  queue.Post(TestMessage{"bulk", nullptr, nullptr});
+
+  for (size_t poll = 0; poll <= MessageQueue::kStarvationLimit; ++poll) {
+    for (size_t i = 0; i < MessageQueue::kBatchSize; ++i) {
+      queue.Post(TestMessage{"normal", nullptr, nullptr}, MessagePriority::kNormal);
+    }
+
+    std::vector<Message> messages;
+    ASSERT_FALSE(queue.Poll(messages));
+
+    const auto bulk_received = std::any_of(messages.begin(), messages.end(), [](const auto& message) {
+      return std::get<TestMessage>(message).Data() == "bulk";
+    });
+
+    EXPECT_EQ(bulk_received, poll == MessageQueue::kStarvationLimit);
+  }
+}
+
+TEST(MessageQueueTests, OverflowPolicies) {
+  MessageQueue queue;
+  std::vector<Message> messages;
+
+  queue.SetLimits({.capacity = 2, .policy = OverflowPolicy::kFailFast, .coalescing_key = {}});
+  EXPECT_FALSE(queue.Post(TestMessage{"1", nullptr, nullptr}));
+  EXPECT_FALSE(queue.Post(TestMessage{"2", nullptr, nullptr}));
+  EXPECT_EQ(queue.Post(TestMessage{"3", nullptr, nullptr}), std::errc::no_buffer_space);
+  EXPECT_EQ(queue.Size(), 2);
+
+  queue.SetLimits({.capacity = 2, .policy = OverflowPolicy::kDropOldest, .coalescing_key = {}});
+  EXPECT_FALSE(queue.Post(TestMessage{"3", nullptr, nullptr}));
+  EXPECT_EQ(queue.Post(SetThreadNameMessage{"control"}), std::error_code{});
+  EXPECT_EQ(queue.DroppedCount(), 2);
+
+  ASSERT_FALSE(queue.Poll(messages));
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_TRUE(std::holds_alternative<SetThreadNameMessage>(messages[0]));
+  EXPECT_EQ(std::get<TestMessage>(messages[1]).Data(), "3");
+
+  queue.SetLimits({
+    .capacity = 2,
+    .policy = OverflowPolicy::kCoalesce,
+    .coalescing_key = [](const Message& message) -> std::optional<uint64_t> {
+      return std::get<TestMessage>(message).Data().size();
+    },
+  });
+
+  EXPECT_FALSE(queue.Post(TestMessage{"a", nullptr, nullptr}));
+  EXPECT_FALSE(queue.Post(TestMessage{"bb", nullptr, nullptr}));
+  EXPECT_FALSE(queue.Post(TestMessage{"c", nullptr, nullptr}));
+  EXPECT_EQ(queue.Post(TestMessage{"ddd", nullptr, nullptr}), std::errc::no_buffer_space);
+
+  ASSERT_FALSE(queue.Poll(messages));
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(std::get<TestMessage>(messages[0]).Data(), "c");
+  EXPECT_EQ(std::get<TestMessage>(messages[1]).Data(), "bb");
+}
+
+TEST(MessageQueueTests, DefaultCoalescingKey) {
+  MessageQueue queue;
+  std::vector<Message> messages;
+  std::vector<int> slots;
+
+  queue.SetLimits({.capacity = 8, .policy = OverflowPolicy::kCoalesce, .coalescing_key = {}});
+
+  //
+  // the calls of different slots of the same receiver are kept
+  //
+  EXPECT_FALSE(queue.Post(InvokeSlotMessage{[&slots] { slots.push_back(1); }, nullptr, nullptr}));
+  EXPECT_FALSE(queue.Post(InvokeSlotMessage{[&slots] { slots.push_back(2); }, nullptr, nullptr}));
+  EXPECT_EQ(queue.Size(), 2);
+
+  //
+  // the replacement of another priority moves to its lane
+  //
+  EXPECT_FALSE(queue.Post(TestMessage{"a", nullptr, nullptr}, MessagePriority::kBulk));
+  EXPECT_FALSE(queue.Post(TestMessage{"b", nullptr, nullptr}, MessagePriority::kTimer));
+  EXPECT_EQ(queue.Size(MessagePriority::kBulk), 0);
+  EXPECT_EQ(queue.Size(MessagePriority::kTimer), 1);
+  EXPECT_EQ(queue.Size(), 3);
+  EXPECT_EQ(queue.DroppedCount(), 1);
+
+  ASSERT_FALSE(queue.Poll(messages));
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(std::get<TestMessage>(messages[0]).Data(), "b");
+
+  std::get<InvokeSlotMessage>(messages[1]).Invoke();
+  std::get<InvokeSlotMessage>(messages[2]).Invoke();
+  EXPECT_EQ(slots, (std::vector<int>{1, 2}));
+}
+
+TEST(MessageQueueTests, CoalescingAcrossLanes) {
+  MessageQueue queue;
+  std::vector<Message> messages;
+
+  queue.SetLimits({
+    .capacity = 4,
+    .policy = OverflowPolicy::kCoalesce,
+    .high_watermark = 0,
+    .low_watermark = 0,
+    .coalescing_key = [](const Message& message) -> std::optional<uint64_t> {
+      return std::get<TestMessage>(message).Data().front();
+    },
+  });
+
+  for (const auto* data : {"a1", "b1", "c1"}) {
+    EXPECT_FALSE(queue.Post(TestMessage{data, nullptr, nullptr}, MessagePriority::kBulk));
+  }
+
+  //
+  // the message in the middle of the lane moves to another lane, the rest
+  // of the pending messages are still coalesced in place
+  //
+  EXPECT_FALSE(queue.Post(TestMessage{"b2", nullptr, nullptr}, MessagePriority::kTimer));
+  EXPECT_FALSE(queue.Post(TestMessage{"c2", nullptr, nullptr}, MessagePriority::kBulk));
+  EXPECT_FALSE(queue.Post(TestMessage{"d1", nullptr, nullptr}, MessagePriority::kBulk));
+  EXPECT_EQ(queue.Post(TestMessage{"e1", nullptr, nullptr}, MessagePriority::kBulk), std::errc::no_buffer_space);
+
+  EXPECT_EQ(queue.Size(), 4);
+  EXPECT_EQ(queue.Size(MessagePriority::kBulk), 3);
+
+  ASSERT_FALSE(queue.Poll(messages));
+
+  std::vector<std::string> data;
+
+  for (const auto& message : messages) {
+    data.push_back(std::get<TestMessage>(message).Data());
+  }
+
+  EXPECT_EQ(data, (std::vector<std::string>{"b2", "a1", "c2", "d1"}));
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+TEST(MessageQueueTests, BlockedProducerAndWatermarks) {
+  MessageQueue queue;
+  std::vector<size_t> watermarks;
+
+  queue.SetLimits({
+    .capacity = 4,
+    .policy = OverflowPolicy::kBlock,
+    .high_watermark = 3,
+    .low_watermark = 0,
+    .coalescing_key = {},
+  });
+
+  queue.SetWatermarkHandlers(
+    [&watermarks](size_t size) { watermarks.push_back(size); },
+    [&watermarks](size_t size) { watermarks.push_back(size); });
+
+  auto producer = std::async(std::launch::async, [&queue] {
+    for (size_t i = 0; i < 5; ++i) {
+      EXPECT_FALSE(queue.Post(TestMessage{std::to_string(i), nullptr, nullptr}));
+    }
+  });
+
+  EXPECT_EQ(producer.wait_for(100ms), std::future_status::timeout);
+  EXPECT_EQ(queue.Size(), 4);
+
+  std::vector<Message> messages;
+  ASSERT_FALSE(queue.Poll(messages));
+  EXPECT_EQ(messages.size(), 4);
+
+  producer.get();
+
+  ASSERT_FALSE(queue.Poll(messages));
+  EXPECT_EQ(messages.size(), 1);
+
+  EXPECT_EQ(watermarks, (std::vector<size_t>{3, 0}));
+}
+
+TEST(MessageQueueTests, NonBlockingPostScope) {
+  MessageQueue queue;
+
+  queue.SetLimits({.capacity = 1, .policy = OverflowPolicy::kBlock, .coalescing_key = {}});
+
+  auto producer = std::async(std::launch::async, [&queue] {
+    EXPECT_FALSE(queue.Post(TestMessage{"a", nullptr, nullptr}));
+
+    {
+      NonBlockingPostScope outer;
+      NonBlockingPostScope inner;
+    }
+
+    NonBlockingPostScope non_blocking;
+
+    EXPECT_EQ(queue.Post(TestMessage{"b", nullptr, nullptr}), std::errc::resource_unavailable_try_again);
+  });
+
+  ASSERT_EQ(producer.wait_for(5s), std::future_status::ready);
+  producer.get();
+
+  EXPECT_FALSE(NonBlockingPostScope::Active());
+  EXPECT_EQ(queue.Size(), 1);
+}
+
+TEST(MessageQueueTests, AdaptiveWaitStages) {
+  MessageQueue queue;
+  std::vector<Message> messages;
+
+  queue.SetWaitOptions({.strategy = WaitStrategy::kAdaptive, .spin_budget = 20us, .yield_budget = 50us});
+
+  //
+  // the pending message is found right away, the idle queue times out
+  //
+  queue.Post(TestMessage{"pending", nullptr, nullptr});
+  ASSERT_FALSE(queue.Poll(messages, MessageQueue::kInfiniteTimeout));
+  EXPECT_EQ(messages.size(), 1);
+
+  EXPECT_EQ(queue.Poll(messages, 1ms), std::errc::timed_out);
+
+  //
+  // the consumer sleeps by the time the message is posted and the post
+  // wakes it up, as does the interruption
+  //
+  auto producer = std::async(std::launch::async, [&queue] {
+    std::this_thread::sleep_for(20ms);
+    queue.Post(TestMessage{"late", nullptr, nullptr});
+
+    std::this_thread::sleep_for(20ms);
+    queue.SetInterruptFlag(true);
+  });
+
+  ASSERT_FALSE(queue.Poll(messages, MessageQueue::kInfiniteTimeout));
+  EXPECT_EQ(messages.size(), 1);
+
+  EXPECT_EQ(queue.Poll(messages, MessageQueue::kInfiniteTimeout), std::errc::interrupted);
+
+  producer.get();
+
+  const auto stats = queue.AdaptiveWaitStats();
+
+  EXPECT_EQ(stats.spun, 1);
+  EXPECT_EQ(stats.timed_out, 1);
+  EXPECT_EQ(stats.yielded + stats.parked, 2);
+  EXPECT_GE(stats.parked, 1);
+}
@@ -0,0 +1,65 @@
+#include "metrics.h"
+#include "metrics_reporter.h"
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(MetricsTests, ThreadCountsAndTimings) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread)
+        : Object{thread},
+          handled_{} {}
+
+    void OnTestMessage(TestMessage&) override { ++handled_; }
+
+    size_t Handled() const noexcept { return handled_; }
+
+   private:
+    std::atomic_size_t handled_;
+  };
+
+  constexpr size_t kMessages = 100;
+
+  Metrics::SetTimingsEnabled(true);
+
+  const auto thread = Thread::Create("metrics");
+  const auto a = MakeUnique<A>(thread.get());
+  auto& queue = GetThreadData(thread.get())->Queue();
+
+  for (size_t i = 0; i < kMessages; ++i) {
+    ASSERT_FALSE(queue.Post(TestMessage{"", nullptr, a.get()}));
+  }
+
+  thread->Start();
+
+  WaitUntil([&a] { return a->Handled() == kMessages; });
+
+  thread->Stop();
+
+  Metrics::SetTimingsEnabled(false);
+
+  const auto snapshot = thread->Metrics();
+
+  EXPECT_EQ(snapshot.thread, "metrics");
+  EXPECT_EQ(snapshot.posted, kMessages);
+  EXPECT_EQ(snapshot.handled, kMessages);
+  EXPECT_EQ(snapshot.queue_depth, 0);
+  EXPECT_EQ(snapshot.queue_depth_high_watermark, kMessages);
+  EXPECT_EQ(snapshot.latency.Count(), kMessages);
+
+  ASSERT_EQ(snapshot.handlers.size(), 1);
+  EXPECT_EQ(snapshot.handlers[0].type, typeid(A).name());
+  EXPECT_EQ(snapshot.handlers[0].calls, kMessages);
+
+  const auto all = Metrics::Collect();
+
+  EXPECT_TRUE(std::any_of(all.begin(), all.end(), [](const auto& thread_snapshot) {
+    return thread_snapshot.thread == "metrics";
+  }));
+
+  MetricsReporter::Report();
+}
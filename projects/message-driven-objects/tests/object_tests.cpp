@@ -1,10 +1,29 @@
+#include "atomic_helpers.h"
 #include "dispatcher.h"
+#include "message_handlers.h"
 #include "object.h"
+#include "shared_buffer.h"
+#include "test_helpers.h"
 #include "test_message.h"
 #include "thread.h"
 #include "timer_message.h"
 
 using namespace mdo;
+using namespace tests;
+
+namespace {
+
+struct CountedPayload {
+  CountedPayload() = default;
+  CountedPayload(const CountedPayload& other) : values{other.values} { ++copies; }
+  CountedPayload(CountedPayload&& other) noexcept = default;
+
+  static inline std::atomic_size_t copies;
+
+  std::vector<int> values;
+};
+
+}// namespace
 
 TEST(ObjectTests, ReceiveTimerMessage) {
   class A : public Object {
@@ -306,3 +325,602 @@ TEST(ObjectTests, ReceiveMessagesSequence) {
 
   EXPECT_EQ(b->Cumulative(), "Hello, World! One, Two, Three, Four, Five.");
 }
+
+TEST(ObjectTests, ReceiveAnyMessage) {
+  struct Small {
+    int value;
+  };
+
+  struct Large {
+    std::array<char, 256> data;
+  };
+
+  class A : public Object {
+   public:
+    using Handlers = MessageHandlers<A, Small, Large>;
+
+    const std::string& Cumulative() const noexcept {
+      return cumulative_;
+    }
+
+   protected:
+    void OnAnyMessage(AnyMessage& message) override {
+      EXPECT_EQ(Thread(), Thread::Current());
+      EXPECT_TRUE(Handlers::Dispatch(this, message));
+    }
+
+   private:
+    friend Handlers;
+
+    void Handle(Small& small) { cumulative_ += std::to_string(small.value); }
+
+    void Handle(Large& large) { cumulative_ += large.data.data(); }
+
+   private:
+    std::string cumulative_;
+  };
+
+  class B : public Object {
+   public:
+    explicit B(Object* receiver) : receiver_{receiver} {
+      Thread()->Started.Connect(this, &B::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      Large large{};
+      std::strcpy(large.data.data(), " large");
+
+      Dispatcher::Dispatch(AnyMessage{Small{42}, this, receiver_});
+      Dispatcher::Dispatch(AnyMessage{large, this, receiver_});
+    }
+
+   private:
+    Object* receiver_;
+  };
+
+  const auto a = std::make_shared<A>();
+  const auto b = std::make_shared<B>(a.get());
+
+  auto future = std::async(std::launch::async, [] {
+    Thread::Sleep(100ms);
+    Dispatcher::Quit();
+  });
+
+  Dispatcher::Instance().Exec();
+
+  future.get();
+
+  EXPECT_EQ(a->Cumulative(), "42 large");
+}
+
+TEST(ObjectTests, CoalescedAndBatchedSignalConnections) {
+  static constexpr int kEmitsCount = 1000;
+
+  //
+  // the receiver's thread is blocked in a slot until all values are emitted,
+  // so the emits are accumulated into one pending call per connection
+  //
+  std::promise<void> blocked;
+  std::promise<void> released;
+
+  class A : public Object {
+   public:
+    A(std::promise<void>& blocked, std::promise<void>& released)
+        : Block{this},
+          ValueChanged{this},
+          blocked_{blocked},
+          released_{released} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      Block();
+      blocked_.get_future().wait();
+
+      for (int i = 1; i <= kEmitsCount; ++i) {
+        ValueChanged(i);
+      }
+
+      released_.set_value();
+    }
+
+    Signal<void> Block;
+    Signal<int> ValueChanged;
+
+   private:
+    std::promise<void>& blocked_;
+    std::promise<void>& released_;
+  };
+
+  class B : public Object {
+   public:
+    B(mdo::Thread* thread, std::promise<void>& blocked, std::promise<void>& released)
+        : Object{thread},
+          coalesced_calls_{},
+          batched_calls_{},
+          last_coalesced_{},
+          done_{},
+          blocked_{blocked},
+          released_{released} {}
+
+    void OnBlock() {
+      blocked_.set_value();
+      released_.get_future().wait();
+    }
+
+    void OnValue(int value) {
+      ++coalesced_calls_;
+      last_coalesced_ = value;
+    }
+
+    void OnValues(Signal<int>::Batch& batch) {
+      ++batched_calls_;
+
+      for (const auto& [value] : batch) {
+        batched_.push_back(value);
+      }
+
+      done_ = batched_.size() == kEmitsCount;
+    }
+
+    size_t CoalescedCalls() const noexcept { return coalesced_calls_; }
+
+    size_t BatchedCalls() const noexcept { return batched_calls_; }
+
+    int LastCoalesced() const noexcept { return last_coalesced_; }
+
+    const std::vector<int>& Batched() const noexcept { return batched_; }
+
+    bool Done() const noexcept { return done_ && last_coalesced_ == kEmitsCount; }
+
+   private:
+    std::atomic_size_t coalesced_calls_;
+    std::atomic_size_t batched_calls_;
+    std::atomic_int last_coalesced_;
+    std::vector<int> batched_;
+    std::atomic_bool done_;
+    std::promise<void>& blocked_;
+    std::promise<void>& released_;
+  };
+
+  const auto thread = Thread::Create("background");
+  const auto a = std::make_shared<A>(blocked, released);
+  const auto b = std::make_shared<B>(thread.get(), blocked, released);
+
+  a->Block.Connect(b.get(), &B::OnBlock);
+  a->ValueChanged.Connect(b.get(), &B::OnValue, DeliveryMode::kCoalesced);
+  a->ValueChanged.Connect(b.get(), &B::OnValues);
+
+  auto future = std::async(std::launch::async, [&b] {
+    WaitUntil([&b] { return b->Done(); });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  thread->Stop();
+
+  std::vector<int> expected;
+
+  for (int i = 1; i <= kEmitsCount; ++i) {
+    expected.push_back(i);
+  }
+
+  EXPECT_EQ(b->LastCoalesced(), kEmitsCount);
+  EXPECT_EQ(b->CoalescedCalls(), 1);
+  EXPECT_EQ(b->Batched(), expected);
+  EXPECT_EQ(b->BatchedCalls(), 1);
+}
+
+TEST(ObjectTests, ExplicitConnectionTypes) {
+  class B : public Object {
+   public:
+    explicit B(mdo::Thread* thread = nullptr)
+        : Object{thread},
+          calls_{},
+          caller_{} {}
+
+    void Slot() {
+      caller_ = Thread::Current();
+      ++calls_;
+    }
+
+    size_t Calls() const noexcept { return calls_; }
+
+    mdo::Thread* Caller() const noexcept { return caller_; }
+
+   private:
+    std::atomic_size_t calls_;
+    std::atomic<mdo::Thread*> caller_;
+  };
+
+  class A : public Object {
+   public:
+    explicit A(const B* queued)
+        : TestSignal{this},
+          queued_{queued},
+          called_synchronously_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      TestSignal();
+      called_synchronously_ = queued_->Calls() != 0;
+    }
+
+    bool CalledSynchronously() const noexcept { return called_synchronously_; }
+
+    Signal<void> TestSignal;
+
+   private:
+    const B* queued_;
+    bool called_synchronously_;
+  };
+
+  const auto thread = Thread::Create("background");
+  const auto queued = std::make_shared<B>();
+  const auto direct = std::make_shared<B>(thread.get());
+  const auto a = std::make_shared<A>(queued.get());
+
+  a->TestSignal.Connect(queued.get(), &B::Slot, ConnectionType::kQueued);
+  a->TestSignal.Connect(direct.get(), &B::Slot, ConnectionType::kDirect);
+
+  auto future = std::async(std::launch::async, [&queued] {
+    WaitUntil([&queued] { return queued->Calls() != 0; });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  thread->Stop();
+
+  //
+  // the queued slot is called by the event loop after the emit returns, the
+  // direct slot is called by the emitting thread
+  //
+  EXPECT_FALSE(a->CalledSynchronously());
+  EXPECT_EQ(queued->Calls(), 1);
+  EXPECT_EQ(queued->Caller(), Dispatcher::Instance().Thread());
+  EXPECT_EQ(direct->Calls(), 1);
+  EXPECT_EQ(direct->Caller(), Dispatcher::Instance().Thread());
+}
+
+TEST(ObjectTests, ConnectionHandles) {
+  class A : public Object {
+   public:
+    A() : TestSignal{this} {}
+
+    Signal<int> TestSignal;
+  };
+
+  class B : public Object {
+   public:
+    void Slot(int value) { sum_ += value; }
+
+    int Sum() const noexcept { return sum_; }
+
+   private:
+    int sum_ = 0;
+  };
+
+  const auto a = MakeUnique<A>();
+  const auto b = MakeUnique<B>();
+  auto c = MakeUnique<B>();
+
+  auto connection = a->TestSignal.Connect(b.get(), &B::Slot);
+  const auto c_connection = a->TestSignal.Connect(c.get(), &B::Slot);
+
+  {
+    const ScopedConnection scoped = a->TestSignal.Connect(b.get(), &B::Slot);
+    a->TestSignal(1);
+  }
+
+  EXPECT_EQ(b->Sum(), 2);
+  EXPECT_EQ(c->Sum(), 1);
+
+  connection.Disconnect();
+  c.reset();
+
+  EXPECT_FALSE(connection.IsConnected());
+  EXPECT_FALSE(c_connection.IsConnected());
+
+  a->TestSignal(10);
+
+  EXPECT_EQ(b->Sum(), 2);
+}
+
+TEST(ObjectTests, ConnectAndDisconnectWhileEmitting) {
+  static constexpr int kConnections = 1'000;
+  static constexpr int kEmitsPerConnection = 4;
+
+  class A : public Object {
+   public:
+    A() : TestSignal{this} {}
+
+    Signal<int> TestSignal;
+  };
+
+  class B : public Object {
+   public:
+    explicit B(std::vector<int>& values) : values_{values} {}
+
+    void Slot(int value) { values_.push_back(value); }
+
+   private:
+    std::vector<int>& values_;
+  };
+
+  const auto a = MakeUnique<A>();
+
+  //
+  // the main thread grants the emits for one connection at a time, drops the
+  // connection while the last of them may be running and grants one more
+  // emit after that
+  //
+  std::atomic_int granted{};
+  std::atomic_int started{};
+  std::atomic_int finished{};
+
+  auto emitter = std::async(std::launch::async, [&] {
+    for (int emit = 1; emit <= kConnections * kEmitsPerConnection; ++emit) {
+      while (granted < emit) {
+        Thread::YieldThread();
+      }
+
+      //
+      // the fence pairs with the fence of the main thread: either the emit
+      // sees the change of the connections or the main thread sees that the
+      // emit has started
+      //
+      StoreRelaxed(started, emit);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      a->TestSignal(emit);
+
+      finished = emit;
+    }
+  });
+
+  //
+  // a failed assertion returns from the test, the rest of the emits are
+  // granted to let the emitting thread finish
+  //
+  struct GrantRest {
+    ~GrantRest() { granted = kConnections * kEmitsPerConnection; }
+
+    std::atomic_int& granted;
+  } grant_rest{granted};
+
+  const auto last_started = [&started] {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return LoadRelaxed(started);
+  };
+
+  const auto wait_finished = [&finished](int emit) {
+    while (finished < emit) {
+      Thread::YieldThread();
+    }
+  };
+
+  for (int i = 0; i < kConnections; ++i) {
+    std::vector<int> values;
+    auto b = MakeUnique<B>(values);
+    auto connection = a->TestSignal.Connect(b.get(), &B::Slot, ConnectionType::kDirect);
+
+    const auto connected_after = last_started();
+
+    granted += kEmitsPerConnection - 1;
+    wait_finished(granted - 1);
+
+    const auto finished_before = LoadSeqCst(finished);
+
+    //
+    // the receiver is either disconnected or retired while its slot may be
+    // running
+    //
+    if (i % 2 == 0) {
+      b.reset();
+    } else {
+      connection.Disconnect();
+    }
+
+    const auto disconnected_after = last_started();
+
+    //
+    // the last emit certainly starts after the disconnection
+    //
+    granted += 1;
+    wait_finished(granted);
+
+    //
+    // the emits which ran entirely while the connection existed reached the
+    // slot, the emits started after the disconnection didn't
+    //
+    for (auto emit = connected_after + 1; emit <= finished_before; ++emit) {
+      ASSERT_NE(std::find(values.begin(), values.end(), emit), values.end()) << "emit " << emit << " is lost";
+    }
+
+    for (const auto value : values) {
+      ASSERT_LE(value, disconnected_after) << "the slot is called after the disconnection";
+    }
+  }
+
+  emitter.get();
+}
+
+TEST(ObjectTests, RetiredSnapshotsAreFreedUnderContinuousEmits) {
+  using SlotConnection = details::SlotConnection<int>;
+
+  const auto make_connection = [](std::function<void(int)> slot) {
+    SlotConnection connection;
+    connection.slot = std::move(slot);
+    connection.direct = [](const SlotConnection& connection, int value) { connection.slot(value); };
+    return connection;
+  };
+
+  details::SlotList<int> slots;
+  std::atomic_bool hold{true};
+  std::atomic_bool held{};
+  std::atomic_bool stop{};
+
+  slots.Add(make_connection([&hold, &held](int) {
+    held = true;
+
+    while (hold) {
+      Thread::YieldThread();
+    }
+  }));
+
+  auto sentinel = std::make_shared<int>();
+  std::vector<std::weak_ptr<int>> observers{sentinel};
+  auto connection = slots.Add(make_connection([sentinel = std::move(sentinel)](int) {}));
+
+  auto emitter = std::async(std::launch::async, [&slots, &stop] {
+    while (!stop) {
+      slots.Emit(1);
+    }
+  });
+
+  //
+  // the snapshot owning the sentinel is replaced while the first emit reads
+  // it, no update follows after the emit has finished
+  //
+  EXPECT_TRUE(WaitUntil([&held] { return held.load(); }));
+
+  connection.Disconnect();
+  slots.Add(make_connection([](int) {}));
+
+  EXPECT_FALSE(observers.front().expired());
+
+  hold = false;
+
+  EXPECT_TRUE(WaitUntil([&observers] { return observers.front().expired(); }));
+
+  //
+  // the snapshots replaced between the emits which never stop are freed too
+  //
+  for (int i = 0; i < 100; ++i) {
+    auto next_sentinel = std::make_shared<int>();
+    observers.push_back(next_sentinel);
+
+    slots.Add(make_connection([next_sentinel = std::move(next_sentinel)](int) {})).Disconnect();
+    slots.Add(make_connection([](int) {})).Disconnect();
+  }
+
+  EXPECT_TRUE(WaitUntil([&observers] {
+    return std::all_of(observers.begin(), observers.end(), [](const auto& observer) { return observer.expired(); });
+  }));
+
+  stop = true;
+  emitter.get();
+}
+
+TEST(ObjectTests, SignalArgumentsAreMovedAndShared) {
+  class A : public Object {
+   public:
+    A()
+        : PayloadSignal{this},
+          BufferSignal{this},
+          UniqueSignal{this} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      CountedPayload payload;
+      payload.values.assign(1024, 1);
+
+      PayloadSignal(std::move(payload));
+      BufferSignal(SharedBuffer{std::string(64 * 1024, 'x')});
+      UniqueSignal(std::make_unique<int>(42));
+    }
+
+    Signal<CountedPayload> PayloadSignal;
+    Signal<const SharedBuffer&> BufferSignal;
+    Signal<std::unique_ptr<int>> UniqueSignal;
+  };
+
+  class B : public Object {
+   public:
+    explicit B(mdo::Thread* thread) : Object{thread}, calls_{} {}
+
+    void OnPayload(CountedPayload payload) {
+      EXPECT_EQ(payload.values.size(), 1024);
+      ++calls_;
+    }
+
+    void OnBuffer(const SharedBuffer& buffer) {
+      buffer_ = buffer;
+      ++calls_;
+    }
+
+    void OnUnique(std::unique_ptr<int> value) {
+      EXPECT_EQ(*value, 42);
+      ++calls_;
+    }
+
+    const SharedBuffer& Buffer() const noexcept { return buffer_; }
+
+    size_t Calls() const noexcept { return calls_; }
+
+   private:
+    SharedBuffer buffer_;
+    std::atomic_size_t calls_;
+  };
+
+  const auto thread = Thread::Create("background");
+  const auto a = std::make_shared<A>();
+
+  std::vector<std::shared_ptr<B>> receivers;
+
+  for (size_t i = 0; i < 3; ++i) {
+    const auto& b = receivers.emplace_back(std::make_shared<B>(thread.get()));
+
+    a->PayloadSignal.Connect(b.get(), &B::OnPayload);
+    a->BufferSignal.Connect(b.get(), &B::OnBuffer);
+  }
+
+  EXPECT_TRUE(a->UniqueSignal.Connect(receivers.front().get(), &B::OnUnique).IsConnected());
+  EXPECT_FALSE(a->UniqueSignal.Connect(receivers.back().get(), &B::OnUnique).IsConnected());
+
+  const auto calls = [&receivers] {
+    size_t result = 0;
+
+    for (const auto& b : receivers) {
+      result += b->Calls();
+    }
+
+    return result;
+  };
+
+  CountedPayload::copies = 0;
+
+  auto future = std::async(std::launch::async, [&calls] {
+    WaitUntil([&calls] { return calls() >= 7; });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  thread->Stop();
+
+  EXPECT_EQ(calls(), 7);
+
+  //
+  // the last connection takes the moved payload
+  //
+  EXPECT_EQ(CountedPayload::copies, 2);
+
+  for (const auto& b : receivers) {
+    EXPECT_EQ(b->Buffer().Data(), receivers.front()->Buffer().Data());
+    EXPECT_EQ(b->Buffer().Size(), 64 * 1024);
+  }
+}
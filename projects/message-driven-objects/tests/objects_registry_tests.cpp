@@ -0,0 +1,207 @@
+#include "objects_registry.h"
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+#include "thread_data.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(ObjectsRegistryTests, HandlesOfRetiredObjectsStayStale) {
+  auto a = std::make_unique<Object>();
+  const auto handle = a->Handle();
+
+  EXPECT_TRUE(ObjectsRegistry::Instance().IsAlive(handle));
+
+  {
+    ObjectPin pin{handle};
+    EXPECT_TRUE(pin);
+  }
+
+  a->Retire();
+  a->Retire();
+
+  EXPECT_FALSE(ObjectsRegistry::Instance().IsAlive(handle));
+  EXPECT_FALSE(ObjectPin{handle});
+
+  //
+  // the new object reuses the slot of the retired one but gets another generation
+  //
+  const auto b = std::make_unique<Object>();
+
+  EXPECT_EQ(b->Handle().index, handle.index);
+  EXPECT_FALSE(ObjectsRegistry::Instance().IsAlive(handle));
+  EXPECT_TRUE(ObjectsRegistry::Instance().IsAlive(b->Handle()));
+}
+
+TEST(ObjectsRegistryTests, RetireWaitsForRunningHandler) {
+  struct State {
+    std::atomic_bool handler_started;
+    std::atomic_bool handler_finished;
+    std::atomic_size_t handled;
+    std::atomic_bool destroyed_while_handling;
+  };
+
+  class A : public Object {
+   public:
+    A(mdo::Thread* thread, State& state) : Object{thread}, state_{state} {}
+
+    ~A() override {
+      state_.destroyed_while_handling = state_.handler_started && !state_.handler_finished;
+    }
+
+   protected:
+    void OnTestMessage(TestMessage&) override {
+      state_.handler_started = true;
+      Thread::Sleep(200ms);
+      ++state_.handled;
+      state_.handler_finished = true;
+    }
+
+   private:
+    State& state_;
+  };
+
+  State state{};
+
+  const auto thread = Thread::Create("background");
+  auto a = MakeUnique<A>(thread.get(), state);
+  auto* receiver = a.get();
+
+  thread->Start();
+
+  ASSERT_FALSE(GetThreadData(thread.get())->Queue().Post(TestMessage{"1", nullptr, receiver}));
+
+  ASSERT_TRUE(WaitUntil([&state] { return state.handler_started.load(); }));
+
+  //
+  // the message is created before the receiver dies, so it carries a handle
+  // which is stale when the message is handled
+  //
+  TestMessage late_message{"2", nullptr, receiver};
+
+  a.reset();
+
+  EXPECT_TRUE(state.handler_finished);
+  EXPECT_FALSE(state.destroyed_while_handling);
+
+  ASSERT_FALSE(GetThreadData(thread.get())->Queue().Post(std::move(late_message)));
+  Thread::Sleep(50ms);
+
+  thread->Stop();
+
+  EXPECT_EQ(state.handled, 1);
+}
+
+TEST(ObjectsRegistryTests, SignalSkipsDestroyedReceiver) {
+  class A : public Object {
+   public:
+    A() : TestSignal{this} {}
+
+    Signal<int> TestSignal;
+  };
+
+  class B : public Object {
+   public:
+    explicit B(int& sum) : sum_{sum} {}
+
+    void Slot(int value) { sum_ += value; }
+
+   private:
+    int& sum_;
+  };
+
+  int sum = 0;
+
+  const auto a = MakeUnique<A>();
+  auto b = MakeUnique<B>(sum);
+
+  a->TestSignal.Connect(b.get(), &B::Slot);
+  a->TestSignal(1);
+
+  b.reset();
+  a->TestSignal(2);
+
+  EXPECT_EQ(sum, 1);
+}
+
+TEST(ObjectsRegistryTests, SessionsChurnWithoutStoppingThreads) {
+  static constexpr size_t kSessionsCount = 20'000;
+
+  struct Stats {
+    std::array<std::atomic_bool, kSessionsCount> retired{};
+    std::atomic_size_t handled{};
+    std::atomic_size_t handled_after_retirement{};
+    std::atomic_size_t stale_handled{};
+  };
+
+  class Session : public Object {
+   public:
+    Session(mdo::Thread* thread, size_t index, Stats& stats)
+        : Object{thread},
+          index_{index},
+          stats_{stats} {}
+
+   protected:
+    void OnTestMessage(TestMessage& message) override {
+      //
+      // the session is pinned while the handler runs, so it can't be retired
+      // meanwhile, and no handler starts after the retirement
+      //
+      if (stats_.retired[index_]) {
+        ++stats_.handled_after_retirement;
+      }
+
+      if (message.Data() == "stale") {
+        ++stats_.stale_handled;
+      }
+
+      data_ += message.Data();
+      ++stats_.handled;
+    }
+
+   private:
+    size_t index_;
+    std::string data_;
+    Stats& stats_;
+  };
+
+  const auto stats = std::make_unique<Stats>();
+
+  const auto thread = Thread::Create("sessions");
+  thread->Start();
+
+  auto& queue = GetThreadData(thread.get())->Queue();
+  const auto objects_count = ObjectsRegistry::Instance().Size();
+
+  for (size_t i = 0; i < kSessionsCount; ++i) {
+    auto session = MakeShared<Session>(thread.get(), i, *stats);
+
+    for (const auto* data : {"a", "b"}) {
+      ASSERT_FALSE(queue.Post(TestMessage{data, nullptr, session.get()}));
+    }
+
+    //
+    // the message is created while the session is alive and posted after it
+    // is retired, so it carries the stale handle
+    //
+    TestMessage stale{"stale", nullptr, session.get()};
+
+    session.reset();
+    stats->retired[i] = true;
+
+    ASSERT_FALSE(queue.Post(std::move(stale)));
+  }
+
+  //
+  // the sessions are destroyed while their messages are being handled, so
+  // only the messages handled before the retirement reach them
+  //
+  EXPECT_TRUE(WaitUntil([&queue] { return queue.Size() == 0; }));
+  thread->Stop();
+
+  EXPECT_LE(stats->handled, 2 * kSessionsCount);
+  EXPECT_EQ(stats->handled_after_retirement, 0);
+  EXPECT_EQ(stats->stale_handled, 0);
+  EXPECT_EQ(ObjectsRegistry::Instance().Size(), objects_count);
+}
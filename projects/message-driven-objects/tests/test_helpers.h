@@ -0,0 +1,33 @@
+#pragma once
+
+#include "dispatcher.h"
+#include "thread.h"
+
+namespace tests {
+
+//
+// polls the predicate until it holds, returns false if the timeout expired
+//
+inline bool WaitUntil(const std::function<bool()>& predicate, std::chrono::milliseconds timeout = std::chrono::seconds{10}) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+
+    mdo::Thread::Sleep(std::chrono::milliseconds{1});
+  }
+
+  return true;
+}
+
+//
+// the dispatcher rejects the messages while its loop is stopped, so the
+// messages are dispatched from another thread once the loop runs
+//
+inline bool WaitForDispatcher() {
+  return WaitUntil([] { return mdo::Dispatcher::Instance().Thread()->State() == mdo::ThreadState::kRunning; });
+}
+
+}// namespace tests
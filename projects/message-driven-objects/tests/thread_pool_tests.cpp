@@ -0,0 +1,175 @@
+#include "dispatcher.h"
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+#include "thread_pool.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(ThreadPoolTests, ObjectReceivesMessagesInOrderOneAtATime) {
+  class A : public Object {
+   public:
+    explicit A(ThreadPool* pool)
+        : Object{pool},
+          in_handler_{},
+          overlapped_{},
+          next_{},
+          out_of_order_{},
+          handled_{} {}
+
+    bool Overlapped() const noexcept { return overlapped_; }
+
+    size_t OutOfOrder() const noexcept { return out_of_order_; }
+
+    size_t Handled() const noexcept { return handled_; }
+
+   protected:
+    void OnTestMessage(TestMessage& message) override {
+      EXPECT_EQ(Thread(), nullptr);
+
+      if (in_handler_.exchange(true)) {
+        overlapped_ = true;
+      }
+
+      if (std::stoul(message.Data()) != next_) {
+        ++out_of_order_;
+      }
+
+      ++next_;
+      in_handler_ = false;
+      ++handled_;
+    }
+
+   private:
+    std::atomic_bool in_handler_;
+    std::atomic_bool overlapped_;
+    size_t next_;
+    size_t out_of_order_;
+    std::atomic<size_t> handled_;
+  };
+
+  constexpr size_t kObjectsCount = 8;
+  constexpr size_t kMessagesCount = 10'000;
+
+  ThreadPool pool{4, "test_pool"};
+
+  std::vector<std::unique_ptr<A>> objects;
+
+  for (size_t i = 0; i < kObjectsCount; ++i) {
+    objects.push_back(std::make_unique<A>(&pool));
+  }
+
+  pool.Start();
+
+  for (size_t i = 0; i < kMessagesCount; ++i) {
+    for (const auto& object : objects) {
+      EXPECT_FALSE(pool.Post(TestMessage{std::to_string(i), nullptr, object.get()}));
+    }
+  }
+
+  const auto all_handled = WaitUntil([&objects] {
+    return std::all_of(objects.begin(), objects.end(), [](const auto& object) {
+      return object->Handled() == kMessagesCount;
+    });
+  });
+
+  pool.Stop();
+
+  EXPECT_TRUE(all_handled);
+
+  for (const auto& object : objects) {
+    EXPECT_FALSE(object->Overlapped());
+    EXPECT_EQ(object->OutOfOrder(), 0);
+  }
+}
+
+TEST(ThreadPoolTests, SignalToObjectInPool) {
+  class A : public Object {
+   public:
+    A() : TestSignal{this} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      TestSignal("One, ");
+      TestSignal("Two, ");
+      TestSignal("Three.");
+    }
+
+    Signal<const std::string&> TestSignal;
+  };
+
+  class B : public Object {
+   public:
+    explicit B(ThreadPool* pool) : Object{pool} {}
+
+    void Slot(const std::string& s) {
+      std::scoped_lock _{mutex_};
+      cumulative_ += s;
+    }
+
+    std::string Cumulative() const {
+      std::scoped_lock _{mutex_};
+      return cumulative_;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    std::string cumulative_;
+  };
+
+  ThreadPool pool{2, "test_pool"};
+
+  const auto a = std::make_shared<A>();
+  const auto b = std::make_shared<B>(&pool);
+  const auto expected = std::string{"One, Two, Three."};
+
+  a->TestSignal.Connect(b.get(), &B::Slot);
+
+  pool.Start();
+
+  auto future = std::async(std::launch::async, [&b, &expected] {
+    WaitUntil([&b, &expected] { return b->Cumulative() == expected; });
+    Dispatcher::Quit();
+  });
+
+  Dispatcher::Instance().Exec();
+
+  future.get();
+  pool.Stop();
+
+  EXPECT_EQ(b->Cumulative(), expected);
+}
+
+TEST(ThreadPoolTests, PostIsRejectedWhileStopped) {
+  class A : public Object {
+   public:
+    explicit A(ThreadPool* pool)
+        : Object{pool},
+          handled_{} {}
+
+    size_t Handled() const noexcept { return handled_; }
+
+   protected:
+    void OnTestMessage(TestMessage&) override { ++handled_; }
+
+   private:
+    std::atomic<size_t> handled_;
+  };
+
+  ThreadPool pool{2, "test_pool"};
+  A object{&pool};
+
+  EXPECT_EQ(pool.Post(TestMessage{"before start", nullptr, &object}), std::errc::operation_canceled);
+
+  pool.Start();
+
+  EXPECT_FALSE(pool.Post(TestMessage{"running", nullptr, &object}));
+  EXPECT_TRUE(WaitUntil([&object] { return object.Handled() == 1; }));
+
+  pool.Stop();
+
+  EXPECT_EQ(pool.Post(TestMessage{"after stop", nullptr, &object}), std::errc::operation_canceled);
+  EXPECT_EQ(object.Handled(), 1);
+}
@@ -0,0 +1,174 @@
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(ThreadTests, LifecycleStates) {
+  const auto thread = Thread::Create("lifecycle");
+
+  EXPECT_EQ(thread->State(), ThreadState::kCreated);
+  EXPECT_FALSE(thread->IsRunning());
+  EXPECT_TRUE(thread->WaitFor(0ms));
+
+  for (size_t run = 0; run < 2; ++run) {
+    thread->Start();
+    EXPECT_TRUE(thread->IsRunning());
+
+    WaitUntil([&thread] { return thread->State() == ThreadState::kRunning; });
+
+    EXPECT_EQ(thread->State(), ThreadState::kRunning);
+    EXPECT_FALSE(thread->WaitFor(10ms));
+
+    thread->Stop();
+
+    EXPECT_EQ(thread->State(), ThreadState::kStopped);
+    EXPECT_FALSE(thread->IsRunning());
+  }
+
+  //
+  // the stop requested right after the start must not be lost
+  //
+  thread->Start();
+  thread->Stop();
+
+  EXPECT_EQ(thread->State(), ThreadState::kStopped);
+}
+
+TEST(ThreadTests, DrainOnStop) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread)
+        : Object{thread},
+          handled_{},
+          handled_before_finished_{} {
+      Thread()->Finished.Connect(this, &A::OnThreadFinished);
+    }
+
+    void OnTestMessage(TestMessage&) override {
+      Thread::Sleep(1ms);
+      ++handled_;
+    }
+
+    void OnThreadFinished() { handled_before_finished_ = handled_.load(); }
+
+    size_t Handled() const noexcept { return handled_; }
+
+    size_t HandledBeforeFinished() const noexcept { return handled_before_finished_; }
+
+   private:
+    std::atomic_size_t handled_;
+    std::atomic_size_t handled_before_finished_;
+  };
+
+  constexpr size_t kMessages = 100;
+
+  const auto thread = Thread::Create("draining");
+  const auto a = MakeUnique<A>(thread.get());
+  auto& queue = GetThreadData(thread.get())->Queue();
+
+  ThreadOptions options;
+  options.stop_mode = StopMode::kDrain;
+  options.drain_timeout = 10s;
+
+  thread->SetOptions(options);
+  thread->Start();
+
+  for (size_t i = 0; i < kMessages; ++i) {
+    ASSERT_FALSE(queue.Post(TestMessage{"", nullptr, a.get()}));
+  }
+
+  thread->Stop();
+
+  EXPECT_EQ(a->Handled(), kMessages);
+  EXPECT_EQ(a->HandledBeforeFinished(), kMessages);
+  EXPECT_EQ(thread->DroppedOnStop(), 0);
+  EXPECT_EQ(queue.Post(TestMessage{"", nullptr, a.get()}), std::errc::broken_pipe);
+
+  //
+  // the drain is cut by the timeout and the rest of messages is dropped
+  //
+  options.drain_timeout = 0ms;
+
+  thread->SetOptions(options);
+  thread->Start();
+
+  for (size_t i = 0; i < kMessages; ++i) {
+    ASSERT_FALSE(queue.Post(TestMessage{"", nullptr, a.get()}));
+  }
+
+  thread->Stop();
+
+  EXPECT_EQ(a->Handled() - kMessages + thread->DroppedOnStop(), kMessages);
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+#if defined(__linux__)
+
+TEST(ThreadTests, OptionsAreAppliedOnStart) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread)
+        : Object{thread},
+          cpu_{-1},
+          started_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      cpu_ = sched_getcpu();
+      started_ = true;
+    }
+
+    int Cpu() const noexcept { return cpu_; }
+
+    bool IsStarted() const noexcept { return started_; }
+
+   private:
+    std::atomic_int cpu_;
+    std::atomic_bool started_;
+  };
+
+  //
+  // the cpuset of a container may exclude CPU 0
+  //
+  cpu_set_t allowed;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+
+  int first_cpu = 0;
+
+  while (!CPU_ISSET(first_cpu, &allowed)) {
+    ++first_cpu;
+  }
+
+  const auto thread = Thread::Create("pinned");
+
+  thread->SetOptions({
+    .cpus = {static_cast<size_t>(first_cpu)},
+    .numa_node = 0,
+    .wait = {.strategy = WaitStrategy::kBusyPoll},
+  });
+
+  const auto a = MakeUnique<A>(thread.get());
+
+  thread->Start();
+
+  WaitUntil([&a] { return a->IsStarted(); });
+
+  thread->Stop();
+
+  EXPECT_TRUE(a->IsStarted());
+  EXPECT_EQ(a->Cpu(), first_cpu);
+  EXPECT_EQ(thread->Options().wait.strategy, WaitStrategy::kBusyPoll);
+  ThreadOptions far_numa_node;
+  far_numa_node.numa_node = 1'000'000;
+
+  ThreadOptions far_cpu;
+  far_cpu.cpus = {CPU_SETSIZE};
+
+  EXPECT_EQ(Thread::SetCurrentThreadOptions(far_numa_node), std::errc::invalid_argument);
+  EXPECT_EQ(Thread::SetCurrentThreadOptions(far_cpu), std::errc::invalid_argument);
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include "dispatcher.h"
+#include "test_helpers.h"
+#include "thread.h"
+#include "timer_message.h"
+#include "timer_service.h"
+
+using namespace mdo;
+using namespace tests;
+
+TEST(TimerServiceTests, TimersOfAllWheelLevelsFireInOrder) {
+  class A : public Object {
+   public:
+    A() : started_{}, done_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      started_ = std::chrono::steady_clock::now();
+
+      for (const auto ms : {300ms, 1ms, 65ms, 10ms, 4100ms, 64ms, 130ms, 63ms}) {
+        intervals_[TimerService::Instance()->AddTimer(this, ms, true)] = ms;
+      }
+
+      for (const auto ms : {20ms, 200ms}) {
+        TimerService::Instance()->RemoveTimer(TimerService::Instance()->AddTimer(this, ms, true));
+      }
+
+      const auto reset_timer_id = TimerService::Instance()->AddTimer(this, 40ms, true);
+      TimerService::Instance()->ResetTimer(reset_timer_id);
+      intervals_[reset_timer_id] = 40ms;
+    }
+
+    const std::vector<std::chrono::milliseconds>& Fired() const noexcept { return fired_; }
+
+    bool Done() const noexcept { return done_; }
+
+   protected:
+    void OnTimerMessage(TimerMessage& msg) override {
+      EXPECT_EQ(Thread(), Thread::Current());
+
+      const auto it = intervals_.find(msg.Id());
+      ASSERT_NE(it, intervals_.end());
+
+      const auto elapsed = std::chrono::steady_clock::now() - started_;
+      EXPECT_GE(elapsed, it->second);
+
+      fired_.push_back(it->second);
+      done_ = fired_.size() == intervals_.size();
+    }
+
+   private:
+    std::chrono::steady_clock::time_point started_;
+    std::map<int, std::chrono::milliseconds> intervals_;
+    std::vector<std::chrono::milliseconds> fired_;
+    std::atomic_bool done_;
+  };
+
+  const auto a = std::make_shared<A>();
+
+  auto future = std::async(std::launch::async, [&a] {
+    WaitUntil([&a] { return a->Done(); });
+
+    Dispatcher::Quit();
+  });
+
+  Dispatcher::Instance().Exec();
+
+  future.get();
+
+  EXPECT_EQ(a->Fired(), (std::vector<std::chrono::milliseconds>{1ms, 10ms, 40ms, 63ms, 64ms, 65ms, 130ms, 300ms, 4100ms}));
+}
+
+TEST(TimerServiceTests, LocalTimersTickInOwnThread) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread) : Object{thread}, periodic_id_{}, killed_id_{}, ticks_{}, killed_ticked_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      periodic_id_ = StartTimer(5ms);
+      killed_id_ = StartTimer(20ms);
+      KillTimer(killed_id_);
+    }
+
+    size_t Ticks() const noexcept { return ticks_; }
+
+    bool KilledTicked() const noexcept { return killed_ticked_; }
+
+   protected:
+    void OnTimerMessage(TimerMessage& msg) override {
+      EXPECT_EQ(Thread(), Thread::Current());
+
+      if (msg.Id() == killed_id_) {
+        killed_ticked_ = true;
+      }
+
+      if (msg.Id() == periodic_id_ && ++ticks_ == 10) {
+        KillTimer(periodic_id_);
+      }
+    }
+
+   private:
+    int periodic_id_;
+    int killed_id_;
+    std::atomic<size_t> ticks_;
+    std::atomic_bool killed_ticked_;
+  };
+
+  const auto thread = Thread::Create("local_timers");
+  const auto a = std::make_shared<A>(thread.get());
+
+  thread->Start();
+  Thread::Sleep(300ms);
+  thread->Stop();
+
+  EXPECT_EQ(a->Ticks(), 10);
+  EXPECT_FALSE(a->KilledTicked());
+}
+
+TEST(TimerServiceTests, SubMillisecondTimersWithHybridWait) {
+  static constexpr auto kInterval = 200us;
+
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread) : Object{thread}, ticks_{}, early_ticks_{} {
+      Thread()->Started.Connect(this, &A::OnThreadStarted);
+    }
+
+    void OnThreadStarted() {
+      started_ = std::chrono::steady_clock::now();
+      StartTimer(kInterval);
+    }
+
+    size_t Ticks() const noexcept { return ticks_; }
+
+    size_t EarlyTicks() const noexcept { return early_ticks_; }
+
+   protected:
+    void OnTimerMessage(TimerMessage&) override {
+      if (std::chrono::steady_clock::now() - started_ < (ticks_ + 1) * kInterval) {
+        ++early_ticks_;
+      }
+
+      ++ticks_;
+    }
+
+   private:
+    std::chrono::steady_clock::time_point started_;
+    std::atomic<size_t> ticks_;
+    std::atomic<size_t> early_ticks_;
+  };
+
+  const auto thread = Thread::Create("hybrid");
+  thread->SetWaitOptions({.strategy = WaitStrategy::kHybrid, .spin_threshold = 50us});
+
+  const auto a = std::make_shared<A>(thread.get());
+
+  thread->Start();
+  Thread::Sleep(100ms);
+  thread->Stop();
+
+  EXPECT_GT(a->Ticks(), 100);
+  EXPECT_EQ(a->EarlyTicks(), 0);
+}
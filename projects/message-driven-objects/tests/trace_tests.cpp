@@ -0,0 +1,201 @@
+#include "dispatcher.h"
+#include "test_helpers.h"
+#include "test_message.h"
+#include "thread.h"
+#include "trace_file.h"
+
+using namespace mdo;
+using namespace tests;
+
+namespace {
+
+struct Order {
+  std::array<char, 100> symbol;
+  int quantity;
+};
+
+}// namespace
+
+TEST(TraceTests, RecordsAreWrittenAndDecoded) {
+  constexpr size_t kMessages = 100;
+
+  const auto path = std::filesystem::temp_directory_path() / "mdo_trace_tests.trace";
+  const auto thread = Thread::Create("traced");
+  const auto sender = MakeUnique<Object>(thread.get());
+  const auto receiver = MakeUnique<Object>(thread.get());
+
+  ASSERT_FALSE(Tracer::Start(path, {.ring_capacity = 256, .flush_interval = 1ms}));
+  EXPECT_TRUE(Tracer::Enabled());
+  EXPECT_EQ(Tracer::Start(path), std::errc::operation_in_progress);
+
+  std::vector<Message> messages;
+
+  for (size_t i = 0; i < kMessages; ++i) {
+    messages.emplace_back(AnyMessage{Order{.symbol = {}, .quantity = static_cast<int>(i)}, sender.get(), receiver.get()});
+    details::TraceDispatched(messages.back());
+  }
+
+  //
+  // the handled records are written by another thread which exits before
+  // the tracing stops, its records must not be lost
+  //
+  std::async(std::launch::async, [&messages] {
+    for (const auto& message : messages) {
+      details::TraceHandled(message);
+    }
+  }).get();
+
+  Tracer::Stop();
+
+  EXPECT_FALSE(Tracer::Enabled());
+  EXPECT_EQ(Tracer::Dropped(), 0);
+
+  TraceFile file;
+  ASSERT_FALSE(TraceFile::Read(path, file));
+
+  ASSERT_EQ(file.records.size(), 2 * kMessages);
+  EXPECT_EQ(file.dropped, 0);
+  EXPECT_EQ(file.threads.size(), 2);
+
+  const auto& dispatched = file.records.front();
+
+  EXPECT_EQ(dispatched.event, TraceEvent::kDispatched);
+  EXPECT_EQ(dispatched.sender, uint64_t{sender->Handle().generation} << 32 | sender->Handle().index);
+  EXPECT_EQ(dispatched.payload_size, sizeof(Order));
+  EXPECT_EQ(file.TypeName(dispatched.type), typeid(Order).name());
+
+  const auto edges = file.Edges();
+
+  ASSERT_EQ(edges.size(), 1);
+  EXPECT_EQ(edges.front().dispatched, kMessages);
+  EXPECT_EQ(edges.front().handled, kMessages);
+  EXPECT_EQ(edges.front().latency.Count(), kMessages);
+  EXPECT_GT(edges.front().latency.Max(), 0ns);
+
+  std::filesystem::remove(path);
+}
+
+TEST(TraceTests, FullRingDropsRecords) {
+  const auto path = std::filesystem::temp_directory_path() / "mdo_trace_drops.trace";
+  const auto thread = Thread::Create("traced");
+  const auto receiver = MakeUnique<Object>(thread.get());
+
+  ASSERT_FALSE(Tracer::Start(path, {.max_records = 10, .flush_interval = 1h}));
+
+  for (size_t i = 0; i < 100; ++i) {
+    Message message{TestMessage{"", nullptr, receiver.get()}};
+    details::TraceDispatched(message);
+  }
+
+  Tracer::Stop();
+
+  TraceFile file;
+  ASSERT_FALSE(TraceFile::Read(path, file));
+
+  EXPECT_EQ(file.records.size(), 10);
+  EXPECT_EQ(file.dropped, 90);
+  EXPECT_EQ(file.TypeName(file.records.front().type), "TestMessage");
+
+  std::filesystem::remove(path);
+}
+
+TEST(TraceTests, UnfinishedAndDamagedFiles) {
+  const auto path = std::filesystem::temp_directory_path() / "mdo_trace_unfinished.trace";
+  const auto thread = Thread::Create("traced");
+  const auto receiver = MakeUnique<Object>(thread.get());
+
+  ASSERT_FALSE(Tracer::Start(path, {.max_records = 1000, .flush_interval = 1ms}));
+
+  for (size_t i = 0; i < 10; ++i) {
+    Message message{TestMessage{"", nullptr, receiver.get()}};
+    details::TraceDispatched(message);
+  }
+
+  //
+  // the file is read while the tracing is still running, as if the process
+  // crashed
+  //
+  TraceFile file;
+
+  WaitUntil([&path, &file] { return !TraceFile::Read(path, file) && file.records.size() >= 10; });
+
+  EXPECT_EQ(file.records.size(), 10);
+  EXPECT_TRUE(file.threads.empty());
+
+  Tracer::Stop();
+
+  //
+  // the header claiming more records than the file has is rejected
+  //
+  {
+    TraceFileHeader header{};
+    std::fstream stream{path, std::ios::binary | std::ios::in | std::ios::out};
+
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    header.records = uint64_t{1} << 40;
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  EXPECT_EQ(TraceFile::Read(path, file), std::errc::illegal_byte_sequence);
+
+  std::filesystem::remove(path);
+}
+
+#if defined(MDO_TRACING)
+
+TEST(TraceTests, DispatchedMessagesAreTraced) {
+  class A : public Object {
+   public:
+    explicit A(mdo::Thread* thread) : Object{thread}, handled_{} {}
+
+    void OnTestMessage(TestMessage&) override { ++handled_; }
+
+    size_t Handled() const noexcept { return handled_; }
+
+   private:
+    std::atomic_size_t handled_;
+  };
+
+  constexpr size_t kMessages = 100;
+
+  const auto path = std::filesystem::temp_directory_path() / "mdo_trace_dispatch.trace";
+  auto& dispatcher = Dispatcher::Instance();
+  const auto thread = Thread::Create("traced");
+  const auto a = MakeUnique<A>(thread.get());
+
+  ASSERT_FALSE(Tracer::Start(path));
+
+  auto future = std::async(std::launch::async, [&a] {
+    WaitForDispatcher();
+
+    for (size_t i = 0; i < kMessages; ++i) {
+      EXPECT_FALSE(Dispatcher::Dispatch(TestMessage{"", nullptr, a.get()}));
+    }
+
+    WaitUntil([&a] { return a->Handled() >= kMessages; });
+
+    Dispatcher::Quit();
+  });
+
+  thread->Start();
+  dispatcher.Exec();
+
+  future.get();
+  thread->Stop();
+  Tracer::Stop();
+
+  TraceFile file;
+  ASSERT_FALSE(TraceFile::Read(path, file));
+
+  const auto edges = file.Edges();
+
+  ASSERT_FALSE(edges.empty());
+  EXPECT_EQ(file.TypeName(edges.front().type), "TestMessage");
+  EXPECT_EQ(edges.front().dispatched, kMessages);
+  EXPECT_EQ(edges.front().handled, kMessages);
+
+  std::filesystem::remove(path);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "trace_file.h"
+
+//
+// Decodes the trace file written by mdo::Tracer and prints the latencies
+// between the enqueue and the dequeue of the messages per sender, receiver
+// and message type:
+//
+//   mdo-trace-decoder mdo.trace
+//   mdo-trace-decoder mdo.trace --dump
+//
+// The handles are printed as "index:generation", the handles of the objects
+// recreated in the same slot differ by the generation.
+//
+
+namespace {
+
+std::string FormatDuration(const std::chrono::nanoseconds& duration) {
+  if (duration < 10us) {
+    return fmt::format("{}ns", duration.count());
+  }
+
+  if (duration < 10ms) {
+    return fmt::format("{}us", std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+  }
+
+  return fmt::format("{}ms", std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+}
+
+void PrintRecords(const mdo::TraceFile& file) {
+  const auto start = file.records.empty() ? 0 : file.records.front().timestamp;
+
+  for (const auto& record : file.records) {
+    std::cout << fmt::format(
+      "{:>12} {:<10} {:<16} {:>12} -> {:<12} {} ({} bytes)\n",
+      record.timestamp - std::min(start, record.timestamp),
+      record.event == mdo::TraceEvent::kDispatched ? "dispatched" : "handled",
+      file.ThreadName(record.thread),
+      mdo::TraceFile::FormatHandle(record.sender),
+      mdo::TraceFile::FormatHandle(record.receiver),
+      file.TypeName(record.type),
+      record.payload_size);
+  }
+}
+
+void PrintEdges(const mdo::TraceFile& file) {
+  std::cout << fmt::format(
+    "{:>12} -> {:<12} {:<32} {:>10} {:>10} {:>8} {:>8} {:>8} {:>8}\n",
+    "sender",
+    "receiver",
+    "type",
+    "dispatched",
+    "handled",
+    "p50",
+    "p99",
+    "p99.9",
+    "max");
+
+  for (const auto& edge : file.Edges()) {
+    const auto& latency = edge.latency;
+
+    std::cout << fmt::format(
+      "{:>12} -> {:<12} {:<32} {:>10} {:>10} {:>8} {:>8} {:>8} {:>8}\n",
+      mdo::TraceFile::FormatHandle(edge.sender),
+      mdo::TraceFile::FormatHandle(edge.receiver),
+      file.TypeName(edge.type),
+      edge.dispatched,
+      edge.handled,
+      FormatDuration(latency.Percentile(50)),
+      FormatDuration(latency.Percentile(99)),
+      FormatDuration(latency.Percentile(99.9)),
+      FormatDuration(latency.Max()));
+  }
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: mdo-trace-decoder <trace file> [--dump]\n";
+    return EXIT_FAILURE;
+  }
+
+  mdo::TraceFile file;
+
+  if (const auto error = mdo::TraceFile::Read(argv[1], file)) {
+    std::cerr << fmt::format("can't read '{}': {}\n", argv[1], error.message());
+    return EXIT_FAILURE;
+  }
+
+  std::cout << fmt::format("{} records, {} dropped, {} threads\n\n", file.records.size(), file.dropped, file.threads.size());
+
+  if (argc > 2 && std::string_view{argv[2]} == "--dump") {
+    PrintRecords(file);
+    std::cout << "\n";
+  }
+
+  PrintEdges(file);
+
+  return EXIT_SUCCESS;
+}
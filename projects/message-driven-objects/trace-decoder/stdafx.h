@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <coroutine>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+
+//
+// Spdlog
+//
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#include <spdlog/fmt/ostr.h>
+#include <spdlog/logger.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#pragma warning(pop)
+
+//
+// tl::expected
+//
+#include <tl/expected.hpp>
+
+#if !defined(_WIN32)
+#if defined(__APPLE__)
+#include <sys/event.h>
+#else
+#include <linux/futex.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#endif
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#else
+#define USE_WINDOWS_SET_THREAD_NAME_HACK
+#include <windows.h>
+#endif
+
+template <typename T>
+std::string ToString(const T& data) {
+  std::stringstream ss;
+  ss << data;
+  return ss.str();
+}
+
+#include "logger.h"
+
+using namespace std::chrono_literals;
\ No newline at end of file